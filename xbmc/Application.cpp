@@ -26,6 +26,7 @@
 #include "guilib/TextureManager.h"
 #include "cores/IPlayer.h"
 #include "cores/AudioEngine/Engines/ActiveAE/ActiveAE.h"
+#include "cores/VideoPlayer/DVDCodecs/DVDFactoryCodec.h"
 #include "cores/playercorefactory/PlayerCoreFactory.h"
 #include "PlayListPlayer.h"
 #include "Autorun.h"
@@ -2513,6 +2514,7 @@ void CApplication::Stop(int exitCode)
 {
   CLog::Log(LOGNOTICE, "Stopping player");
   m_appPlayer.ClosePlayer();
+  CDVDFactoryCodec::ClearAudioCodecPool();
 
   {
     // close inbound port
@@ -2741,6 +2743,30 @@ bool CApplication::PlayStack(CFileItem& item, bool bRestart)
   return PlayFile(selectedStackPart, "", true);
 }
 
+bool CApplication::HasEpisodeBookmark(CFileItem& item)
+{
+  if (!item.IsVideo())
+    return false;
+
+  // tags of library items carry the bookmark already. PlayFile loads the tag of other items from
+  // the database, so do the same to find the episode's bookmark in a multi-episode file
+  if (!item.HasVideoInfoTag() || item.GetVideoInfoTag()->m_iDbId <= 0)
+  {
+    CVideoDatabase dbs;
+    if (!dbs.Open())
+      return false;
+
+    std::string path = item.GetPath();
+    std::string videoInfoTagPath(item.GetVideoInfoTag()->m_strFileNameAndPath);
+    if (videoInfoTagPath.find("removable://") == 0)
+      path = videoInfoTagPath;
+    dbs.LoadVideoInfo(path, *item.GetVideoInfoTag());
+    dbs.Close();
+  }
+
+  return item.GetVideoInfoTag()->m_iBookmarkId > 0;
+}
+
 bool CApplication::PlayFile(CFileItem item, const std::string& player, bool bRestart)
 {
   // Ensure the MIME type has been retrieved for http:// and shout:// streams
@@ -3850,6 +3876,14 @@ bool CApplication::OnMessage(CGUIMessage& message)
 
       if (!file.IsVideo() && m_appPlayer.IsPlayingVideo())
         bNothingToQueue = true;
+      else if (m_stackHelper.IsPlayingRegularStack() || m_stackHelper.IsPlayingISOStack())
+        bNothingToQueue = true; // the next part of the stack comes first
+      else if (m_appPlayer.IsPlayingVideo() && file.IsStack())
+        bNothingToQueue = true; // stacks are set up by PlayStack
+      else if (m_appPlayer.IsPlayingVideo() &&
+               (file.m_lStartOffset != 0 || file.HasProperty("StartPercent") ||
+                file.HasProperty("savedplayerstate") || HasEpisodeBookmark(file)))
+        bNothingToQueue = true; // start time and player state are worked out by PlayFile
       else if ((!file.IsAudio() || file.IsVideo()) && m_appPlayer.IsPlayingAudio())
         bNothingToQueue = true;
 
@@ -457,6 +457,7 @@ protected:
   void VolumeChanged();
 
   bool PlayStack(CFileItem& item, bool bRestart);
+  bool HasEpisodeBookmark(CFileItem& item);
 
   float NavigationIdleTime();
   void HandlePortEvents();
@@ -8,8 +8,12 @@
 
 #include "GUILargeTextureManager.h"
 
+#include "ServiceBroker.h"
 #include "TextureCache.h"
+#include "guilib/GUIComponent.h"
 #include "guilib/Texture.h"
+#include "settings/AdvancedSettings.h"
+#include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
 #include "threads/SystemClock.h"
 #include "utils/JobManager.h"
@@ -17,6 +21,7 @@
 #include "utils/log.h"
 #include "windowing/GraphicContext.h"
 
+#include <algorithm>
 #include <cassert>
 
 CImageLoader::CImageLoader(const std::string &path, const bool useCache):
@@ -124,7 +129,24 @@ void CGUILargeTextureManager::CLargeTexture::SetTexture(CBaseTexture* texture)
     m_texture.Set(texture, texture->GetWidth(), texture->GetHeight());
 }
 
-CGUILargeTextureManager::CGUILargeTextureManager() = default;
+size_t CGUILargeTextureManager::CLargeTexture::GetMemoryUsage() const
+{
+  size_t size = 0;
+  for (const auto texture : m_texture.m_textures)
+    size += static_cast<size_t>(texture->GetPitch()) * texture->GetRows();
+  return size;
+}
+
+namespace
+{
+// initial estimate for textures that are still loading, a 512x512 RGBA thumb
+const size_t DEFAULT_TEXTURE_SIZE = 512 * 512 * 4;
+}
+
+CGUILargeTextureManager::CGUILargeTextureManager()
+  : m_averageTextureSize(DEFAULT_TEXTURE_SIZE)
+{
+}
 
 CGUILargeTextureManager::~CGUILargeTextureManager() = default;
 
@@ -135,7 +157,7 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
   listIterator it = m_allocated.begin();
   while (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
+    CLargeTexture *image = it->second;
     if (image->DeleteIfRequired(immediately))
       it = m_allocated.erase(it);
     else
@@ -148,18 +170,21 @@ void CGUILargeTextureManager::CleanupUnusedImages(bool immediately)
 bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &texture, bool firstRequest, const bool useCache)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  const bool prefetched = firstRequest && m_prefetchedPaths.find(path) != m_prefetchedPaths.end();
+  listIterator it = m_allocated.find(path);
+  if (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (firstRequest)
-        image->AddRef();
-      texture = image->GetTexture();
-      return texture.size() > 0;
-    }
+    CLargeTexture *image = it->second;
+    if (firstRequest)
+      image->AddRef();
+    if (prefetched)
+      m_prefetchHits++;
+    texture = image->GetTexture();
+    return texture.size() > 0;
   }
 
+  if (prefetched)
+    m_prefetchMisses++;
   if (firstRequest)
     QueueImage(path, useCache);
 
@@ -169,68 +194,135 @@ bool CGUILargeTextureManager::GetImage(const std::string &path, CTextureArray &t
 void CGUILargeTextureManager::ReleaseImage(const std::string &path, bool immediately)
 {
   CSingleLock lock(m_listSection);
-  for (listIterator it = m_allocated.begin(); it != m_allocated.end(); ++it)
+  ReleaseImageInternal(path, immediately);
+}
+
+void CGUILargeTextureManager::ReleaseImageInternal(const std::string &path, bool immediately)
+{
+  listIterator it = m_allocated.find(path);
+  if (it != m_allocated.end())
   {
-    CLargeTexture *image = *it;
-    if (image->GetPath() == path)
-    {
-      if (image->DecrRef(immediately) && immediately)
-        m_allocated.erase(it);
-      return;
-    }
+    CLargeTexture *image = it->second;
+    if (image->DecrRef(immediately) && immediately)
+      m_allocated.erase(it);
+    return;
   }
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  queueIterator queued = m_queued.find(path);
+  if (queued != m_queued.end())
   {
-    unsigned int id = it->first;
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path && image->DecrRef(true))
+    unsigned int id = queued->second.first;
+    CLargeTexture *image = queued->second.second;
+    if (image->DecrRef(true))
     {
       // cancel this job
       CJobManager::GetInstance().CancelJob(id);
-      m_queued.erase(it);
-      return;
+      m_queued.erase(queued);
     }
   }
 }
 
 // queue the image, and start the background loader if necessary
-void CGUILargeTextureManager::QueueImage(const std::string &path, bool useCache)
+void CGUILargeTextureManager::QueueImage(const std::string &path, bool useCache, CJob::PRIORITY priority)
 {
   if (path.empty())
     return;
 
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
+  queueIterator it = m_queued.find(path);
+  if (it != m_queued.end())
   {
-    CLargeTexture *image = it->second;
-    if (image->GetPath() == path)
-    {
-      image->AddRef();
-      return; // already queued
-    }
+    it->second.second->AddRef();
+    return; // already queued
   }
 
   // queue the item
   CLargeTexture *image = new CLargeTexture(path);
-  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, useCache), this, CJob::PRIORITY_NORMAL);
-  m_queued.emplace_back(jobID, image);
+  unsigned int jobID = CJobManager::GetInstance().AddJob(new CImageLoader(path, useCache), this, priority);
+  m_queued.emplace(path, std::make_pair(jobID, image));
+}
+
+void CGUILargeTextureManager::PrefetchImages(const void *owner, const std::vector<std::string> &paths, bool useCache)
+{
+  const size_t budget = static_cast<size_t>(CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiPrefetchMemory) * 1024 * 1024;
+
+  CSingleLock lock(m_listSection);
+  std::vector<std::string> &prefetched = m_prefetched[owner];
+
+  // take our references to the wanted images before dropping the old ones, so that images
+  // present in both sets are never unloaded in between
+  std::vector<std::string> wanted;
+  size_t usage = 0;
+  for (const auto &path : paths)
+  {
+    if (path.empty() || std::find(wanted.begin(), wanted.end(), path) != wanted.end())
+      continue;
+
+    // images still loading count with an estimate, or a fast scroll would queue far past the budget
+    listIterator it = m_allocated.find(path);
+    const size_t size = it != m_allocated.end() ? it->second->GetMemoryUsage() : m_averageTextureSize;
+    if (usage + size > budget)
+      break;
+    usage += size;
+
+    if (it != m_allocated.end())
+      it->second->AddRef();
+    else
+      QueueImage(path, useCache, CJob::PRIORITY_LOW);
+    wanted.push_back(path);
+    m_prefetchedPaths[path]++;
+  }
+
+  // release the previous set, cancelling loads that are no longer wanted
+  ReleasePrefetchedPaths(prefetched);
+
+  prefetched.swap(wanted);
+}
+
+void CGUILargeTextureManager::ReleasePrefetchedPaths(const std::vector<std::string> &paths)
+{
+  for (const auto &path : paths)
+  {
+    ReleaseImageInternal(path, false);
+
+    auto it = m_prefetchedPaths.find(path);
+    if (it != m_prefetchedPaths.end() && --it->second == 0)
+      m_prefetchedPaths.erase(it);
+  }
+}
+
+void CGUILargeTextureManager::ReleasePrefetchedImages(const void *owner)
+{
+  CSingleLock lock(m_listSection);
+  auto it = m_prefetched.find(owner);
+  if (it == m_prefetched.end())
+    return;
+
+  ReleasePrefetchedPaths(it->second);
+  m_prefetched.erase(it);
+
+  CLog::Log(LOGDEBUG, "%s - %u textures were ready on first request, %u had to be loaded", __FUNCTION__, m_prefetchHits, m_prefetchMisses);
+}
+
+bool CGUILargeTextureManager::IsImageRequested(const std::string &path) const
+{
+  CSingleLock lock(m_listSection);
+  return m_allocated.find(path) != m_allocated.end() || m_queued.find(path) != m_queued.end();
 }
 
 void CGUILargeTextureManager::OnJobComplete(unsigned int jobID, bool success, CJob *job)
 {
   // see if we still have this job id
+  CImageLoader *loader = static_cast<CImageLoader*>(job);
   CSingleLock lock(m_listSection);
-  for (queueIterator it = m_queued.begin(); it != m_queued.end(); ++it)
-  {
-    if (it->first == jobID)
-    { // found our job
-      CImageLoader *loader = static_cast<CImageLoader*>(job);
-      CLargeTexture *image = it->second;
-      image->SetTexture(loader->m_texture);
-      loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
-      m_queued.erase(it);
-      m_allocated.push_back(image);
-      return;
-    }
+  queueIterator it = m_queued.find(loader->m_path);
+  if (it != m_queued.end() && it->second.first == jobID)
+  { // found our job
+    CLargeTexture *image = it->second.second;
+    image->SetTexture(loader->m_texture);
+    loader->m_texture = NULL; // we want to keep the texture, and jobs are auto-deleted.
+    m_queued.erase(it);
+    if (image->GetMemoryUsage() > 0)
+      m_averageTextureSize = (m_averageTextureSize * 7 + image->GetMemoryUsage()) / 8;
+    m_allocated.emplace(image->GetPath(), image);
   }
 }
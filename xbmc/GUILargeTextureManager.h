@@ -12,6 +12,9 @@
 #include "threads/CriticalSection.h"
 #include "utils/Job.h"
 
+#include <map>
+#include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -103,6 +106,37 @@ public:
    */
   void CleanupUnusedImages(bool immediately = false);
 
+  /*!
+   \brief Request textures to be loaded ahead of them being displayed.
+
+   Used by containers to keep the artwork of items just outside the visible area loaded while
+   scrolling. Each call replaces the previous prefetch set of the given owner: images no longer
+   wanted are released (cancelling their load if it is still pending) and new ones are queued at
+   low priority. Paths are expected in priority order, closest to the visible area first; once the
+   prefetch memory budget is used up, the remaining paths are ignored. Images that are still loading
+   are accounted for with the average size of the textures loaded so far.
+
+   \param owner the requesting object, typically the container control.
+   \param paths paths of the images to prefetch, most important first.
+   \param useCache whether or not to use any caching with these images.
+   \sa ReleasePrefetchedImages
+   */
+  void PrefetchImages(const void *owner, const std::vector<std::string> &paths, bool useCache = true);
+
+  /*!
+   \brief Release all textures prefetched for the given owner.
+   \param owner the object the images were prefetched for.
+   \sa PrefetchImages
+   */
+  void ReleasePrefetchedImages(const void *owner);
+
+  /*!
+   \brief Check whether a texture has been requested, i.e. is loaded or queued for loading.
+   \param path path of the image.
+   \return true if the image is loaded or queued, false otherwise.
+   */
+  bool IsImageRequested(const std::string &path) const;
+
 private:
   class CLargeTexture
   {
@@ -117,6 +151,7 @@ private:
 
     const std::string &GetPath() const { return m_path; };
     const CTextureArray &GetTexture() const { return m_texture; };
+    size_t GetMemoryUsage() const;
 
   private:
     static const unsigned int TIME_TO_DELETE = 2000;
@@ -127,13 +162,22 @@ private:
     unsigned int m_timeToDelete;
   };
 
-  void QueueImage(const std::string &path, bool useCache = true);
+  void QueueImage(const std::string &path, bool useCache = true, CJob::PRIORITY priority = CJob::PRIORITY_NORMAL);
+  void ReleaseImageInternal(const std::string &path, bool immediately);
+  void ReleasePrefetchedPaths(const std::vector<std::string> &paths);
+
+  std::unordered_map<std::string, std::pair<unsigned int, CLargeTexture *> > m_queued;
+  std::unordered_map<std::string, CLargeTexture *> m_allocated;
+  typedef std::unordered_map<std::string, CLargeTexture *>::iterator listIterator;
+  typedef std::unordered_map<std::string, std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+
+  std::map<const void *, std::vector<std::string> > m_prefetched; ///< prefetched paths per owner
+  std::unordered_map<std::string, unsigned int> m_prefetchedPaths; ///< number of owners prefetching each path
 
-  std::vector< std::pair<unsigned int, CLargeTexture *> > m_queued;
-  std::vector<CLargeTexture *> m_allocated;
-  typedef std::vector<CLargeTexture *>::iterator listIterator;
-  typedef std::vector< std::pair<unsigned int, CLargeTexture *> >::iterator queueIterator;
+  size_t m_averageTextureSize; ///< running average of the memory used by loaded textures
+  unsigned int m_prefetchHits = 0;   ///< first requests of prefetched images that were already loaded
+  unsigned int m_prefetchMisses = 0; ///< first requests of prefetched images still loading (blank until loaded)
 
-  CCriticalSection m_listSection;
+  mutable CCriticalSection m_listSection;
 };
 
@@ -13,11 +13,14 @@
 
 #include "FileItem.h"
 #include "ServiceBroker.h"
+#include "URL.h"
 #include "addons/AddonManager.h"
 #include "addons/AddonSystemSettings.h"
 #include "filesystem/File.h"
 #include "music/Album.h"
 #include "music/Artist.h"
+#include "utils/XMLPullReader.h"
+#include "utils/log.h"
 #include "video/VideoInfoDownloader.h"
 
 #include <string>
@@ -50,30 +53,11 @@ CInfoScanner::INFO_TYPE CNfoFile::Create(const std::string& strPath,
   else if (m_type == ADDON_SCRAPER_TVSHOWS || m_type == ADDON_SCRAPER_MOVIES
            || m_type == ADDON_SCRAPER_MUSICVIDEOS)
   {
-    // first check if it's an XML file with the info we need
-    CVideoInfoTag details;
-    bNfo = GetDetails(details);
+    // first check if it's an XML file with the info we need. Details are loaded by the
+    // caller, a root element is all CVideoInfoTag::Load needs to succeed.
+    bNfo = CXMLPullReader(m_doc).ReadRootElement();
     if (episode > -1 && bNfo && m_type == ADDON_SCRAPER_TVSHOWS)
-    {
-      int infos=0;
-      while (m_headPos != std::string::npos && details.m_iEpisode != episode)
-      {
-        m_headPos = m_doc.find("<episodedetails", m_headPos + 1);
-        if (m_headPos == std::string::npos)
-          break;
-
-        bNfo  = GetDetails(details);
-        infos++;
-      }
-      if (details.m_iEpisode != episode)
-      {
-        bNfo = false;
-        details.Reset();
-        m_headPos = 0;
-        if (infos == 1) // still allow differing nfo/file numbers for single ep nfo's
-          bNfo = GetDetails(details);
-      }
-    }
+      bNfo = FindEpisode(episode);
   }
 
   std::vector<ScraperPtr> vecScrapers = GetScrapers(m_type, m_info);
@@ -135,7 +119,12 @@ int CNfoFile::Load(const std::string& strFile)
   if (file.LoadFile(strFile, buf) > 0)
   {
     m_doc.assign(buf.get(), buf.size());
+    // the nfo is scanned as is, unless it is in UTF-16 or the like
+    if (!CXMLPullReader::ConvertToUtf8(m_doc))
+      CLog::Log(LOGWARNING, "%s: failed to convert %s to UTF-8", __FUNCTION__,
+                CURL::GetRedacted(strFile).c_str());
     m_headPos = 0;
+    m_headLength = std::string::npos;
     return 0;
   }
   m_doc.clear();
@@ -146,9 +135,41 @@ void CNfoFile::Close()
 {
   m_doc.clear();
   m_headPos = 0;
+  m_headLength = std::string::npos;
   m_scurl.Clear();
 }
 
+bool CNfoFile::FindEpisode(int episode)
+{
+  int currentEpisode = -1;
+  int infos = 0;
+  m_headPos = 0;
+  for (;;)
+  {
+    CXMLPullReader reader(m_doc.c_str() + m_headPos, m_doc.size() - m_headPos);
+    if (!reader.ReadRootElement())
+      return false;
+
+    // episode isn't reset between elements, same as loading them into one tag
+    reader.GetInt("episode", currentEpisode);
+    if (currentEpisode == episode)
+    {
+      m_headLength = reader.SkipElement() ? reader.GetTokenEnd() : std::string::npos;
+      return true;
+    }
+
+    m_headPos = m_doc.find("<episodedetails", m_headPos + 1);
+    if (m_headPos == std::string::npos)
+      break;
+    infos++;
+  }
+
+  m_headPos = 0;
+  m_headLength = std::string::npos;
+  // still allow differing nfo/file numbers for single ep nfo's
+  return infos == 1;
+}
+
 std::vector<ScraperPtr> CNfoFile::GetScrapers(TYPE type,
                                               ScraperPtr selectedScraper)
 {
@@ -32,7 +32,7 @@ public:
     if (document)
       doc.Parse(document, TIXML_ENCODING_UNKNOWN);
     else if (m_headPos < m_doc.size())
-      doc.Parse(m_doc.substr(m_headPos), TIXML_ENCODING_UNKNOWN);
+      doc.Parse(m_doc.substr(m_headPos, m_headLength), TIXML_ENCODING_UNKNOWN);
     else
       return false;
 
@@ -53,9 +53,17 @@ public:
 private:
   std::string m_doc;
   size_t m_headPos = 0;
+  size_t m_headLength = std::string::npos;
   ADDON::ScraperPtr m_info;
   ADDON::TYPE m_type = ADDON::ADDON_UNKNOWN;
   CScraperUrl m_scurl;
 
   int Load(const std::string&);
+
+  /*! \brief Find the details of an episode in a multi-episode nfo without parsing it.
+   Sets m_headPos and m_headLength to the matching element, the first one is used for single
+   episode nfos that don't match.
+   \return true if details were found
+   */
+  bool FindEpisode(int episode);
 };
@@ -395,7 +395,7 @@ void CUtil::CleanString(const std::string& strFileName,
   CRegExp reTags(true, CRegExp::autoUtf8);
   CRegExp reYear(false, CRegExp::autoUtf8);
 
-  if (!reYear.RegComp(advancedSettings->m_videoCleanDateTimeRegExp))
+  if (!reYear.RegComp(advancedSettings->m_videoCleanDateTimeRegExp, CRegExp::StudyWithJitComp))
   {
     CLog::Log(LOGERROR, "%s: Invalid datetime clean RegExp:'%s'", __FUNCTION__, advancedSettings->m_videoCleanDateTimeRegExp.c_str());
   }
@@ -412,7 +412,7 @@ void CUtil::CleanString(const std::string& strFileName,
 
   for (const auto &regexp : regexps)
   {
-    if (!reTags.RegComp(regexp.c_str()))
+    if (!reTags.RegComp(regexp.c_str(), CRegExp::StudyWithJitComp))
     { // invalid regexp - complain in logs
       CLog::Log(LOGERROR, "%s: Invalid string clean RegExp:'%s'", __FUNCTION__, regexp.c_str());
       continue;
@@ -532,7 +532,7 @@ bool CUtil::ExcludeFileOrFolder(const std::string& strFileOrFolder, const std::v
 
   for (const auto &regexp : regexps)
   {
-    if (!regExExcludes.RegComp(regexp.c_str()))
+    if (!regExExcludes.RegComp(regexp.c_str(), CRegExp::StudyWithJitComp))
     { // invalid regexp - complain in logs
       CLog::Log(LOGERROR, "%s: Invalid exclude RegExp:'%s'", __FUNCTION__, regexp.c_str());
       continue;
@@ -23,9 +23,13 @@
 #include "addons/AddonProvider.h"
 #include "cores/VideoPlayer/DVDCodecs/DVDCodecs.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Timer.h"
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <list>
+
 
 //------------------------------------------------------------------------------
 // Video
@@ -200,6 +204,148 @@ CDVDAudioCodec* CDVDFactoryCodec::CreateAudioCodec(CDVDStreamInfo &hint, CProces
   return nullptr;
 }
 
+namespace
+{
+
+struct PooledAudioCodec
+{
+  CDVDStreamInfo hint;
+  bool allowpassthrough = false;
+  bool allowdtshddecode = false;
+  CAEStreamInfo::DataType ptStreamType = CAEStreamInfo::STREAM_TYPE_NULL;
+  unsigned int releaseTime = 0;
+  // the codec keeps a reference to its process info, so it has to be destroyed first
+  std::unique_ptr<CProcessInfo> processInfo;
+  std::unique_ptr<CDVDAudioCodec> codec;
+};
+
+constexpr size_t MAX_POOLED_AUDIO_CODECS = 2;
+constexpr unsigned int POOLED_AUDIO_CODEC_TIMEOUT = 30000; // ms
+
+std::list<PooledAudioCodec> pooledAudioCodecs;
+unsigned int audioCodecRequests = 0;
+unsigned int audioCodecReuses = 0;
+
+// expires pooled codecs while nothing asks for codecs, armed while the pool isn't empty
+CTimer* purgeTimer = nullptr;
+bool purgeTimerArmed = false;
+
+void PurgeAudioCodecPool()
+{
+  const unsigned int now = XbmcThreads::SystemClockMillis();
+  pooledAudioCodecs.remove_if([now](const PooledAudioCodec& pooled) {
+    return now - pooled.releaseTime > POOLED_AUDIO_CODEC_TIMEOUT;
+  });
+}
+
+void OnPurgeTimeout()
+{
+  CSingleLock lock(audioCodecSection);
+
+  PurgeAudioCodecPool();
+  if (pooledAudioCodecs.empty() || !purgeTimer)
+  {
+    purgeTimerArmed = false;
+    return;
+  }
+
+  // wait for the oldest remaining codec, restarting from the callback keeps the timer running
+  const unsigned int age = XbmcThreads::SystemClockMillis() - pooledAudioCodecs.front().releaseTime;
+  purgeTimer->RestartAsync(age < POOLED_AUDIO_CODEC_TIMEOUT ? POOLED_AUDIO_CODEC_TIMEOUT - age + 1 : 1);
+}
+
+} // unnamed namespace
+
+void CDVDFactoryCodec::ReleaseAudioCodec(std::unique_ptr<CDVDAudioCodec> codec,
+                                         std::unique_ptr<CProcessInfo> processInfo,
+                                         CDVDStreamInfo &hint,
+                                         bool allowpassthrough, bool allowdtshddecode,
+                                         CAEStreamInfo::DataType ptStreamType)
+{
+  if (!codec || !processInfo)
+    return;
+
+  codec->Reset();
+
+  CSingleLock lock(audioCodecSection);
+
+  PurgeAudioCodecPool();
+  if (pooledAudioCodecs.size() >= MAX_POOLED_AUDIO_CODECS)
+    pooledAudioCodecs.pop_front();
+
+  pooledAudioCodecs.emplace_back();
+  PooledAudioCodec& pooled = pooledAudioCodecs.back();
+  pooled.hint = hint;
+  pooled.allowpassthrough = allowpassthrough;
+  pooled.allowdtshddecode = allowdtshddecode;
+  pooled.ptStreamType = ptStreamType;
+  pooled.releaseTime = XbmcThreads::SystemClockMillis();
+  pooled.processInfo = std::move(processInfo);
+  pooled.codec = std::move(codec);
+
+  if (!purgeTimerArmed)
+  {
+    if (!purgeTimer)
+      purgeTimer = new CTimer(OnPurgeTimeout);
+
+    // a previous run has already decided to end, make sure its thread is gone before restarting
+    purgeTimer->Stop(true);
+    purgeTimer->Start(POOLED_AUDIO_CODEC_TIMEOUT + 1);
+    purgeTimerArmed = true;
+  }
+}
+
+std::unique_ptr<CDVDAudioCodec> CDVDFactoryCodec::AcquireAudioCodec(CDVDStreamInfo &hint,
+                                                                    std::unique_ptr<CProcessInfo>& processInfo,
+                                                                    bool allowpassthrough, bool allowdtshddecode,
+                                                                    CAEStreamInfo::DataType ptStreamType)
+{
+  std::unique_ptr<CDVDAudioCodec> codec;
+
+  CSingleLock lock(audioCodecSection);
+
+  PurgeAudioCodecPool();
+  audioCodecRequests++;
+
+  for (auto it = pooledAudioCodecs.begin(); it != pooledAudioCodecs.end(); ++it)
+  {
+    if (it->allowpassthrough == allowpassthrough && it->allowdtshddecode == allowdtshddecode &&
+        it->ptStreamType == ptStreamType && it->hint.Equal(hint, true))
+    {
+      processInfo = std::move(it->processInfo);
+      codec = std::move(it->codec);
+      pooledAudioCodecs.erase(it);
+
+      audioCodecReuses++;
+      CLog::Log(LOGDEBUG, "CDVDFactoryCodec::AcquireAudioCodec - reusing codec %s (%u of %u requests)",
+                codec->GetName().c_str(), audioCodecReuses, audioCodecRequests);
+      break;
+    }
+  }
+
+  return codec;
+}
+
+void CDVDFactoryCodec::ClearAudioCodecPool()
+{
+  CTimer* timer = nullptr;
+  {
+    CSingleLock lock(audioCodecSection);
+
+    if (audioCodecRequests > 0)
+      CLog::Log(LOGDEBUG, "CDVDFactoryCodec::ClearAudioCodecPool - reused %u of %u audio codecs",
+                audioCodecReuses, audioCodecRequests);
+
+    pooledAudioCodecs.clear();
+    timer = purgeTimer;
+    purgeTimer = nullptr;
+    purgeTimerArmed = false;
+  }
+
+  // stopping waits for a running callback, which needs the lock
+  delete timer;
+}
+
 void CDVDFactoryCodec::RegisterHWAudioCodec(std::string id, CreateHWAudioCodec createFunc)
 {
   CSingleLock lock(audioCodecSection);
@@ -12,6 +12,7 @@
 #include "cores/AudioEngine/Utils/AEStreamInfo.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -46,6 +47,33 @@ public:
                                           bool allowpassthrough, bool allowdtshddecode,
                                           CAEStreamInfo::DataType ptStreamType);
 
+  /*!
+   * \brief Hand back an audio codec that is no longer needed, together with the process info it
+   * was created for. The codec is flushed and kept for a short while, so that the next stream with
+   * equal hints and options (e.g. the next item of a music playlist) does not pay the open cost.
+   */
+  static void ReleaseAudioCodec(std::unique_ptr<CDVDAudioCodec> codec,
+                                std::unique_ptr<CProcessInfo> processInfo,
+                                CDVDStreamInfo &hint,
+                                bool allowpassthrough, bool allowdtshddecode,
+                                CAEStreamInfo::DataType ptStreamType);
+
+  /*!
+   * \brief Get a released audio codec matching the given hints and options.
+   * On success, processInfo is replaced by the process info the codec was created for.
+   * \return the codec or nullptr if there is no matching one
+   */
+  static std::unique_ptr<CDVDAudioCodec> AcquireAudioCodec(CDVDStreamInfo &hint,
+                                                           std::unique_ptr<CProcessInfo>& processInfo,
+                                                           bool allowpassthrough, bool allowdtshddecode,
+                                                           CAEStreamInfo::DataType ptStreamType);
+
+  /*!
+   * \brief Destroy all released audio codecs. Must be called before shutting down, codecs expire
+   * on their own otherwise.
+   */
+  static void ClearAudioCodecPool();
+
   static CDVDOverlayCodec* CreateOverlayCodec(CDVDStreamInfo &hint);
 
   static void RegisterHWVideoCodec(std::string id, CreateHWVideoCodec createFunc);
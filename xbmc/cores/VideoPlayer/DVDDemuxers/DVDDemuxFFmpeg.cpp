@@ -8,8 +8,12 @@
 
 #include "DVDDemuxFFmpeg.h"
 
+#include <deque>
+#include <map>
+#include <memory>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include "commons/Exception.h"
 #include "cores/FFmpeg.h"
@@ -74,6 +78,121 @@ static const struct StereoModeConversionMap WmvToInternalStereoModeMap[] =
 
 #define FF_MAX_EXTRADATA_SIZE ((1 << 28) - AV_INPUT_BUFFER_PADDING_SIZE)
 
+namespace
+{
+
+/*!
+ * Remembers the stream layout and codec parameters of live transport streams, detected by
+ * avformat_find_stream_info. Switching back to a channel with an unchanged layout can then take
+ * the fast switch path and skip stream probing.
+ */
+class CStreamInfoCache
+{
+public:
+  static CStreamInfoCache& GetInstance()
+  {
+    static CStreamInfoCache cache;
+    return cache;
+  }
+
+  void Store(const std::string& path, const AVFormatContext* context)
+  {
+    Entry entry;
+    for (unsigned int i = 0; i < context->nb_streams; ++i)
+    {
+      const AVStream* st = context->streams[i];
+      CachedStream stream;
+      stream.id = st->id;
+      stream.avg_frame_rate = st->avg_frame_rate;
+      stream.r_frame_rate = st->r_frame_rate;
+      stream.params.reset(avcodec_parameters_alloc());
+      if (!stream.params || avcodec_parameters_copy(stream.params.get(), st->codecpar) < 0)
+        return;
+
+      entry.emplace_back(std::move(stream));
+    }
+
+    CSingleLock lock(m_critSection);
+    if (m_entries.find(path) == m_entries.end())
+    {
+      if (m_order.size() >= MAX_ENTRIES)
+      {
+        m_entries.erase(m_order.front());
+        m_order.pop_front();
+      }
+      m_order.emplace_back(path);
+    }
+    m_entries[path] = std::move(entry);
+  }
+
+  /*!
+   * Fill in the codec parameters of the streams found so far, if they match the cached layout.
+   * Video extradata is not restored, the demuxer waits for it to start at an i-frame.
+   */
+  bool Restore(const std::string& path, AVFormatContext* context)
+  {
+    CSingleLock lock(m_critSection);
+    const auto it = m_entries.find(path);
+    if (it == m_entries.end())
+      return false;
+
+    const Entry& entry = (*it).second;
+    if (context->nb_streams == 0 || context->nb_streams != entry.size())
+      return false;
+
+    for (unsigned int i = 0; i < context->nb_streams; ++i)
+    {
+      const AVStream* st = context->streams[i];
+      const AVCodecParameters* params = entry[i].params.get();
+      if (st->id != entry[i].id || st->codecpar->codec_type != params->codec_type ||
+          st->codecpar->codec_id != params->codec_id)
+        return false;
+    }
+
+    for (unsigned int i = 0; i < context->nb_streams; ++i)
+    {
+      AVStream* st = context->streams[i];
+      if (avcodec_parameters_copy(st->codecpar, entry[i].params.get()) < 0)
+        return false;
+
+      if (st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO)
+      {
+        av_freep(&st->codecpar->extradata);
+        st->codecpar->extradata_size = 0;
+      }
+      st->avg_frame_rate = entry[i].avg_frame_rate;
+      st->r_frame_rate = entry[i].r_frame_rate;
+    }
+    return true;
+  }
+
+private:
+  CStreamInfoCache() = default;
+
+  struct CodecParametersDeleter
+  {
+    void operator()(AVCodecParameters* params) { avcodec_parameters_free(&params); }
+  };
+
+  struct CachedStream
+  {
+    int id = 0;
+    AVRational avg_frame_rate = {0, 1};
+    AVRational r_frame_rate = {0, 1};
+    std::unique_ptr<AVCodecParameters, CodecParametersDeleter> params;
+  };
+
+  using Entry = std::vector<CachedStream>;
+
+  static constexpr size_t MAX_ENTRIES = 64;
+
+  CCriticalSection m_critSection;
+  std::map<std::string, Entry> m_entries;
+  std::deque<std::string> m_order;
+};
+
+} // unnamed namespace
+
 std::string CDemuxStreamAudioFFmpeg::GetStreamName()
 {
   if (!m_stream)
@@ -481,6 +600,15 @@ bool CDVDDemuxFFmpeg::Open(std::shared_ptr<CDVDInputStream> pInput, bool streami
   m_bAVI = strcmp(m_pFormatContext->iformat->name, "avi") == 0;
   m_bSup = strcmp(m_pFormatContext->iformat->name, "sup") == 0;
 
+  // switching back to a live channel with an unchanged stream layout, no need to probe again
+  const bool bCacheStreamInfo = m_streaminfo && m_checkTransportStream && m_pInput->IsRealtime();
+  if (bCacheStreamInfo && CStreamInfoCache::GetInstance().Restore(strFile, m_pFormatContext))
+  {
+    CLog::Log(LOGDEBUG, "%s - restored stream info of %u streams, skipping avformat_find_stream_info",
+              __FUNCTION__, m_pFormatContext->nb_streams);
+    m_streaminfo = false;
+  }
+
   if (m_streaminfo)
   {
     /* to speed up dvd switches, only analyse very short */
@@ -508,6 +636,9 @@ bool CDVDDemuxFFmpeg::Open(std::shared_ptr<CDVDInputStream> pInput, bool streami
     }
     CLog::Log(LOGDEBUG, "%s - av_find_stream_info finished", __FUNCTION__);
 
+    if (iErr >= 0 && bCacheStreamInfo)
+      CStreamInfoCache::GetInstance().Store(strFile, m_pFormatContext);
+
     // print some extra information
     av_dump_format(m_pFormatContext, 0, CURL::GetRedacted(strFile).c_str(), 0);
 
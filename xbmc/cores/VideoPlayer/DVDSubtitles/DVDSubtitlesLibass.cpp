@@ -15,11 +15,15 @@
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "threads/Thread.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/log.h"
 #include "windowing/GraphicContext.h"
 
+// number of frames the worker renders ahead of playback
+#define RENDER_AHEAD_FRAMES 3
+
 static void libass_log(int level, const char *fmt, va_list args, void *data)
 {
   if(level >= 5)
@@ -73,6 +77,13 @@ CDVDSubtitlesLibass::CDVDSubtitlesLibass()
 
 CDVDSubtitlesLibass::~CDVDSubtitlesLibass()
 {
+  if (m_thread)
+  {
+    m_stop = true;
+    m_requestEvent.Set();
+    m_thread.reset();
+  }
+
   if(m_track)
     ass_free_track(m_track);
   ass_renderer_done(m_renderer);
@@ -82,23 +93,28 @@ CDVDSubtitlesLibass::~CDVDSubtitlesLibass()
 /*Decode Header of SSA, needed to properly decode demux packets*/
 bool CDVDSubtitlesLibass::DecodeHeader(char* data, int size)
 {
-  CSingleLock lock(m_section);
+  CSingleLock libassLock(m_libassSection);
   if(!m_library || !data)
     return false;
 
   if(!m_track)
   {
     CLog::Log(LOGINFO, "CDVDSubtitlesLibass: Creating new ASS track");
-    m_track = ass_new_track(m_library) ;
+    ASS_Track* track = ass_new_track(m_library);
+    CSingleLock lock(m_section);
+    m_track = track;
   }
 
   ass_process_codec_private(m_track, data, size);
+
+  CSingleLock lock(m_section);
+  m_trackVersion++;
   return true;
 }
 
 bool CDVDSubtitlesLibass::DecodeDemuxPkt(const char* data, int size, double start, double duration)
 {
-  CSingleLock lock(m_section);
+  CSingleLock libassLock(m_libassSection);
   if(!m_track)
   {
     CLog::Log(LOGERROR, "CDVDSubtitlesLibass: No SSA header found.");
@@ -107,12 +123,15 @@ bool CDVDSubtitlesLibass::DecodeDemuxPkt(const char* data, int size, double star
 
   //! @bug libass isn't const correct
   ass_process_chunk(m_track, const_cast<char*>(data), size, DVD_TIME_TO_MSEC(start), DVD_TIME_TO_MSEC(duration));
+
+  CSingleLock lock(m_section);
+  m_trackVersion++;
   return true;
 }
 
 bool CDVDSubtitlesLibass::CreateTrack(char* buf, size_t size)
 {
-  CSingleLock lock(m_section);
+  CSingleLock libassLock(m_libassSection);
   if(!m_library)
   {
     CLog::Log(LOGERROR, "CDVDSubtitlesLibass: %s - No ASS library struct", __FUNCTION__);
@@ -121,13 +140,24 @@ bool CDVDSubtitlesLibass::CreateTrack(char* buf, size_t size)
 
   CLog::Log(LOGINFO, "SSA Parser: Creating m_track from SSA buffer");
 
-  m_track = ass_read_memory(m_library, buf, size, 0);
-  if(m_track == NULL)
+  ASS_Track* track = ass_read_memory(m_library, buf, size, 0);
+  if(track == NULL)
     return false;
 
+  CSingleLock lock(m_section);
+  m_track = track;
+  m_trackVersion++;
   return true;
 }
 
+bool CDVDSubtitlesLibass::RenderParams::operator==(const RenderParams& right) const
+{
+  return frameWidth == right.frameWidth && frameHeight == right.frameHeight &&
+         videoWidth == right.videoWidth && videoHeight == right.videoHeight &&
+         sourceWidth == right.sourceWidth && sourceHeight == right.sourceHeight &&
+         useMargin == right.useMargin && position == right.position;
+}
+
 ASS_Image* CDVDSubtitlesLibass::RenderImage(int frameWidth, int frameHeight, int videoWidth, int videoHeight, int sourceWidth, int sourceHeight,
                                             double pts, int useMargin, double position, int *changes)
 {
@@ -138,21 +168,186 @@ ASS_Image* CDVDSubtitlesLibass::RenderImage(int frameWidth, int frameHeight, int
     return NULL;
   }
 
-  double sar = (double)sourceWidth / sourceHeight;
-  double dar = (double)videoWidth / videoHeight;
-  ass_set_frame_size(m_renderer, frameWidth, frameHeight);
-  int topmargin = (frameHeight - videoHeight) / 2;
-  int leftmargin = (frameWidth - videoWidth) / 2;
+  const RenderParams params = {frameWidth, frameHeight, videoWidth,  videoHeight,
+                               sourceWidth, sourceHeight, useMargin, position};
+  const long long time = DVD_TIME_TO_MSEC(pts);
+
+  // same request as last time, the caller can keep what it made of the previous images
+  if (m_current && m_current->params == params && m_current->time == time &&
+      m_current->trackVersion == m_trackVersion)
+  {
+    if (changes)
+      *changes = 0;
+    return m_current->images.empty() ? nullptr : m_current->images.data();
+  }
+
+  // forget the frames rendered ahead that were passed or no longer match
+  while (!m_ahead.empty() && m_ahead.front()->time < time)
+    m_ahead.pop_front();
+  if (!m_ahead.empty() &&
+      (m_ahead.front()->time != time || !(m_ahead.front()->params == params) ||
+       m_ahead.front()->trackVersion != m_trackVersion))
+    m_ahead.clear();
+
+  std::unique_ptr<RenderedFrame> frame;
+  if (!m_ahead.empty())
+  {
+    frame = std::move(m_ahead.front());
+    m_ahead.pop_front();
+  }
+  else
+  {
+    // the worker didn't see this one coming, render it here
+    lock.Leave();
+    {
+      CSingleLock libassLock(m_libassSection);
+      frame = Render(params, pts);
+    }
+    lock.Enter();
+  }
+
+  if (changes)
+  {
+    if (!m_current)
+      *changes = 2;
+    else if (frame->serial == m_current->serial + 1)
+      *changes = frame->changes; // libass compared with the images the caller has
+    else
+      *changes = Compare(*m_current, *frame);
+  }
+  m_current = std::move(frame);
+
+  // playback moves forward by about one frame per call, render the next ones ahead of time
+  if (pts > m_lastPts && pts - m_lastPts < DVD_TIME_BASE)
+    RequestRender(params, pts, pts - m_lastPts);
+  m_lastPts = pts;
+
+  return m_current->images.empty() ? nullptr : m_current->images.data();
+}
+
+std::unique_ptr<CDVDSubtitlesLibass::RenderedFrame> CDVDSubtitlesLibass::Render(
+    const RenderParams& params, double pts)
+{
+  double sar = (double)params.sourceWidth / params.sourceHeight;
+  double dar = (double)params.videoWidth / params.videoHeight;
+  ass_set_frame_size(m_renderer, params.frameWidth, params.frameHeight);
+  int topmargin = (params.frameHeight - params.videoHeight) / 2;
+  int leftmargin = (params.frameWidth - params.videoWidth) / 2;
   ass_set_margins(m_renderer, topmargin, topmargin, leftmargin, leftmargin);
-  ass_set_use_margins(m_renderer, useMargin);
-  ass_set_line_position(m_renderer, position);
+  ass_set_use_margins(m_renderer, params.useMargin);
+  ass_set_line_position(m_renderer, params.position);
   ass_set_aspect_ratio(m_renderer, dar, sar);
-  return ass_render_frame(m_renderer, m_track, DVD_TIME_TO_MSEC(pts), changes);
+
+  std::unique_ptr<RenderedFrame> frame(new RenderedFrame());
+  frame->params = params;
+  frame->pts = pts;
+  frame->time = DVD_TIME_TO_MSEC(pts);
+  frame->trackVersion = m_trackVersion;
+  frame->serial = ++m_renderSerial;
+
+  ASS_Image* images = ass_render_frame(m_renderer, m_track, frame->time, &frame->changes);
+  for (ASS_Image* image = images; image; image = image->next)
+    frame->images.push_back(*image);
+
+  // unless libass reports changed images, the bitmaps are those of the previous render
+  if (frame->changes != 2 && m_lastBitmaps && m_lastBitmaps->size() == frame->images.size())
+    frame->bitmaps = m_lastBitmaps;
+  else
+  {
+    frame->bitmaps = std::make_shared<Bitmaps>();
+    frame->bitmaps->reserve(frame->images.size());
+    for (ASS_Image* image = images; image; image = image->next)
+      frame->bitmaps->emplace_back(image->bitmap, image->bitmap + image->stride * image->h);
+  }
+  m_lastBitmaps = frame->bitmaps;
+
+  for (size_t i = 0; i < frame->images.size(); i++)
+  {
+    frame->images[i].bitmap = (*frame->bitmaps)[i].data();
+    frame->images[i].next = i + 1 < frame->images.size() ? &frame->images[i + 1] : nullptr;
+  }
+
+  return frame;
+}
+
+int CDVDSubtitlesLibass::Compare(const RenderedFrame& previous, const RenderedFrame& frame)
+{
+  if (!(previous.params == frame.params) || previous.images.size() != frame.images.size())
+    return 2;
+
+  int changes = 0;
+  for (size_t i = 0; i < frame.images.size(); i++)
+  {
+    const ASS_Image& a = previous.images[i];
+    const ASS_Image& b = frame.images[i];
+    if (a.w != b.w || a.h != b.h || a.stride != b.stride || a.color != b.color || a.type != b.type)
+      return 2;
+    if (a.dst_x != b.dst_x || a.dst_y != b.dst_y)
+      changes = 1;
+  }
+
+  // only compare the bitmaps themselves if they don't come from the same render
+  if (previous.bitmaps != frame.bitmaps && *previous.bitmaps != *frame.bitmaps)
+    return 2;
+
+  return changes;
+}
+
+void CDVDSubtitlesLibass::RequestRender(const RenderParams& params, double pts, double interval)
+{
+  m_requestParams = params;
+  m_requestPts = pts;
+  m_requestInterval = interval;
+  m_requestPending = true;
+
+  if (!m_thread)
+  {
+    m_thread.reset(new CThread(this, "LibassRenderer"));
+    m_thread->Create();
+  }
+  m_requestEvent.Set();
+}
+
+void CDVDSubtitlesLibass::Run()
+{
+  while (!m_stop)
+  {
+    m_requestEvent.Wait();
+
+    // keep a few frames ready, following the frames already rendered ahead
+    while (!m_stop)
+    {
+      RenderParams params;
+      double pts;
+      {
+        CSingleLock lock(m_section);
+        if (!m_requestPending || !m_renderer || !m_track || m_ahead.size() >= RENDER_AHEAD_FRAMES)
+        {
+          m_requestPending = false;
+          break;
+        }
+
+        params = m_requestParams;
+        pts = (m_ahead.empty() ? m_requestPts : m_ahead.back()->pts) + m_requestInterval;
+      }
+
+      std::unique_ptr<RenderedFrame> frame;
+      {
+        CSingleLock libassLock(m_libassSection);
+        frame = Render(params, pts);
+      }
+
+      CSingleLock lock(m_section);
+      if (frame->params == m_requestParams && frame->trackVersion == m_trackVersion &&
+          frame->pts > (m_ahead.empty() ? m_lastPts : m_ahead.back()->pts))
+        m_ahead.push_back(std::move(frame));
+    }
+  }
 }
 
 ASS_Event* CDVDSubtitlesLibass::GetEvents()
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_libassSection);
   if(!m_track)
   {
     CLog::Log(LOGERROR, "CDVDSubtitlesLibass: %s -  Missing ASS structs(m_track)", __FUNCTION__);
@@ -163,9 +358,8 @@ ASS_Event* CDVDSubtitlesLibass::GetEvents()
 
 int CDVDSubtitlesLibass::GetNrOfEvents()
 {
-  CSingleLock lock(m_section);
+  CSingleLock lock(m_libassSection);
   if(!m_track)
     return 0;
   return m_track->n_events;
 }
-
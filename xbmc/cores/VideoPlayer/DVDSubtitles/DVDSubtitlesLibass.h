@@ -10,17 +10,34 @@
 
 #include "DVDResource.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
+#include "threads/IRunnable.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
 
 #include <ass/ass.h>
 
+class CThread;
+
 /** Wrapper for Libass **/
 
-class CDVDSubtitlesLibass : public IDVDResourceCounted<CDVDSubtitlesLibass>
+class CDVDSubtitlesLibass : public IDVDResourceCounted<CDVDSubtitlesLibass>, private IRunnable
 {
 public:
   CDVDSubtitlesLibass();
   ~CDVDSubtitlesLibass() override;
 
+  /*!
+   * @brief Render the subtitle images for the given pts.
+   *
+   * The returned images stay valid until the next call. While the pts keeps advancing, the
+   * images for the following frames are rendered ahead on a worker thread.
+   * @param changes set like ass_render_frame does, relative to the images returned by the
+   *                previous call: 0 if identical, 1 if only moved, 2 if changed
+   */
   ASS_Image* RenderImage(int frameWidth, int frameHeight, int videoWidth, int videoHeight, int sourceWidth, int sourceHeight,
                          double pts, int useMargin = 0, double position = 0.0, int* changes = NULL);
   ASS_Event* GetEvents();
@@ -32,9 +49,70 @@ public:
   bool CreateTrack(char* buf, size_t size);
 
 private:
+  struct RenderParams
+  {
+    int frameWidth;
+    int frameHeight;
+    int videoWidth;
+    int videoHeight;
+    int sourceWidth;
+    int sourceHeight;
+    int useMargin;
+    double position;
+
+    bool operator==(const RenderParams& right) const;
+  };
+
+  typedef std::vector<std::vector<unsigned char>> Bitmaps;
+
+  //! deep copy of an ASS_Image list, which libass invalidates on the next render
+  struct RenderedFrame
+  {
+    RenderParams params;
+    double pts = 0.0;
+    long long time = 0;
+    unsigned int trackVersion = 0;
+    unsigned int serial = 0; //!< number of the libass render that produced the frame
+    int changes = 2; //!< change detected by libass, relative to the render before
+    std::vector<ASS_Image> images;
+    std::shared_ptr<Bitmaps> bitmaps; //!< shared with the previous render if libass found no change
+  };
+
+  void Run() override;
+  //! needs m_libassSection
+  std::unique_ptr<RenderedFrame> Render(const RenderParams& params, double pts);
+  void RequestRender(const RenderParams& params, double pts, double interval);
+
+  /*!
+   * @brief Compare two rendered frames the way ass_render_frame reports changes.
+   * @return 0 if identical, 1 if only the image positions differ, 2 if the content differs
+   */
+  static int Compare(const RenderedFrame& previous, const RenderedFrame& frame);
+
   ASS_Library* m_library = nullptr;
   ASS_Track* m_track = nullptr;
   ASS_Renderer* m_renderer = nullptr;
+
+  //! serialises all libass calls. the render thread doesn't need it while frames rendered ahead
+  //! are available, so it never waits for a render in progress on the worker
+  CCriticalSection m_libassSection;
+  unsigned int m_renderSerial = 0;
+  std::shared_ptr<Bitmaps> m_lastBitmaps;
+
+  //! guards the state below, only held briefly
   CCriticalSection m_section;
+
+  unsigned int m_trackVersion = 0; //!< changed with both locks held
+  std::unique_ptr<RenderedFrame> m_current;
+  std::deque<std::unique_ptr<RenderedFrame>> m_ahead;
+  double m_lastPts = 0.0;
+
+  RenderParams m_requestParams;
+  double m_requestPts = 0.0;
+  double m_requestInterval = 0.0;
+  bool m_requestPending = false;
+  CEvent m_requestEvent;
+  std::atomic_bool m_stop{false};
+  std::unique_ptr<CThread> m_thread;
 };
 
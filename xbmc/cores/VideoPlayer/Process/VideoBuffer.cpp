@@ -8,9 +8,14 @@
 
 #include "VideoBuffer.h"
 
+#include "threads/Condition.h"
+#include "threads/IRunnable.h"
 #include "threads/SingleLock.h"
+#include "threads/Thread.h"
 
+#include <algorithm>
 #include <string.h>
+#include <thread>
 
 //-----------------------------------------------------------------------------
 // CVideoBuffer
@@ -48,125 +53,185 @@ AVPixelFormat CVideoBuffer::GetFormat()
   return m_pixFormat;
 }
 
-bool CVideoBuffer::CopyPicture(YuvImage* pDst, YuvImage *pSrc)
+namespace
 {
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width * pDst->bpp;
-  int h = pDst->height;
-  if ((w == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
+
+// planes smaller than this are not worth waking up the copy threads for
+constexpr size_t PARALLEL_COPY_MIN_SIZE = 1024 * 1024;
+constexpr unsigned int PARALLEL_COPY_MAX_THREADS = 4;
+
+struct PlaneCopy
+{
+  uint8_t* dst;
+  int dstStride;
+  const uint8_t* src;
+  int srcStride;
+  int width;
+  int height;
+};
+
+void CopyRows(const PlaneCopy& plane, int firstRow, int rows)
+{
+  const uint8_t* s = plane.src + static_cast<ptrdiff_t>(firstRow) * plane.srcStride;
+  uint8_t* d = plane.dst + static_cast<ptrdiff_t>(firstRow) * plane.dstStride;
+  if ((plane.width == plane.srcStride) && (plane.srcStride == plane.dstStride))
   {
-    memcpy(d, s, w*h);
+    memcpy(d, s, static_cast<size_t>(plane.width) * rows);
   }
   else
   {
-    for (int y = 0; y < h; y++)
+    for (int y = 0; y < rows; y++)
     {
-      memcpy(d, s, w);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
+      memcpy(d, s, plane.width);
+      s += plane.srcStride;
+      d += plane.dstStride;
     }
   }
-  s = pSrc->plane[1];
-  d = pDst->plane[1];
-  w =(pDst->width  >> pDst->cshift_x) * pDst->bpp;
-  h =(pDst->height >> pDst->cshift_y);
-  if ((w == pSrc->stride[1]) && (pSrc->stride[1] == pDst->stride[1]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
+}
+
+/*!
+ * Splits the rows of large planes into slices which are copied by the calling thread and a
+ * few helper threads. A single copy of a 2160p plane is bound by what one core can move,
+ * spreading it over several cores shortens the time the render thread spends uploading.
+ */
+class CSlicedPlaneCopy : public IRunnable
+{
+public:
+  CSlicedPlaneCopy()
   {
-    for (int y = 0; y < h; y++)
+    const unsigned int threads =
+        std::min(std::thread::hardware_concurrency(), PARALLEL_COPY_MAX_THREADS);
+    for (unsigned int i = 1; i < threads; ++i)
     {
-      memcpy(d, s, w);
-      s += pSrc->stride[1];
-      d += pDst->stride[1];
+      m_workers.emplace_back(new CThread(this, "PlaneCopy"));
+      m_workers.back()->Create();
     }
+    m_slices = static_cast<int>(m_workers.size()) + 1;
   }
-  s = pSrc->plane[2];
-  d = pDst->plane[2];
-  if ((w == pSrc->stride[2]) && (pSrc->stride[2] == pDst->stride[2]))
+
+  static CSlicedPlaneCopy& GetInstance()
   {
-    memcpy(d, s, w*h);
+    // never destroyed, the idle threads must not tear down after the logger on exit
+    static CSlicedPlaneCopy* instance = new CSlicedPlaneCopy();
+    return *instance;
   }
-  else
+
+  void Copy(const PlaneCopy& plane)
   {
-    for (int y = 0; y < h; y++)
+    // concurrent callers and small planes get the plain copy
+    if (m_workers.empty() ||
+        static_cast<size_t>(plane.width) * plane.height < PARALLEL_COPY_MIN_SIZE ||
+        m_busy.exchange(true))
     {
-      memcpy(d, s, w);
-      s += pSrc->stride[2];
-      d += pDst->stride[2];
+      CopyRows(plane, 0, plane.height);
+      return;
     }
-  }
-  return true;
-}
 
+    {
+      CSingleLock lock(m_section);
+      m_plane = plane;
+      m_pendingSlices = m_slices;
+      m_nextSlice = 0;
+      m_generation++;
+    }
+    m_start.notifyAll();
+
+    CopySlices();
 
-bool CVideoBuffer::CopyNV12Picture(YuvImage* pDst, YuvImage *pSrc)
-{
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width;
-  int h = pDst->height;
-  // Copy Y
-  if ((w == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
-  {
-    memcpy(d, s, w*h);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
     {
-      memcpy(d, s, w);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
+      CSingleLock lock(m_section);
+      while (m_pendingSlices > 0)
+        m_done.wait(lock);
     }
+    m_busy = false;
   }
 
-  s = pSrc->plane[1];
-  d = pDst->plane[1];
-  w = pDst->width;
-  h = pDst->height >> 1;
-  // Copy packed UV (width is same as for Y as it's both U and V components)
-  if ((w == pSrc->stride[1]) && (pSrc->stride[1] == pDst->stride[1]))
+  void Run() override
   {
-    memcpy(d, s, w*h);
+    unsigned int generation = 0;
+    while (true)
+    {
+      {
+        CSingleLock lock(m_section);
+        while (m_generation == generation)
+          m_start.wait(lock);
+        generation = m_generation;
+      }
+      CopySlices();
+    }
   }
-  else
+
+private:
+  void CopySlices()
   {
-    for (int y = 0; y < h; y++)
+    int slice;
+    while ((slice = m_nextSlice++) < m_slices)
     {
-      memcpy(d, s, w);
-      s += pSrc->stride[1];
-      d += pDst->stride[1];
+      const int rowsPerSlice = (m_plane.height + m_slices - 1) / m_slices;
+      const int firstRow = slice * rowsPerSlice;
+      const int rows = std::min(rowsPerSlice, m_plane.height - firstRow);
+      if (rows > 0)
+        CopyRows(m_plane, firstRow, rows);
+
+      if (--m_pendingSlices == 0)
+      {
+        CSingleLock lock(m_section);
+        m_done.notifyAll();
+      }
     }
   }
 
-  return true;
+  CCriticalSection m_section;
+  XbmcThreads::ConditionVariable m_start;
+  XbmcThreads::ConditionVariable m_done;
+  std::vector<std::unique_ptr<CThread>> m_workers;
+  std::atomic_bool m_busy{false};
+  unsigned int m_generation = 0;
+  int m_slices = 1;
+  PlaneCopy m_plane = {};
+  std::atomic_int m_nextSlice{0};
+  std::atomic_int m_pendingSlices{0};
+};
+
+void CopyPlane(uint8_t* dst, int dstStride, const uint8_t* src, int srcStride, int width, int height)
+{
+  CSlicedPlaneCopy::GetInstance().Copy({dst, dstStride, src, srcStride, width, height});
 }
 
-bool CVideoBuffer::CopyYUV422PackedPicture(YuvImage* pDst, YuvImage *pSrc)
+} // unnamed namespace
+
+bool CVideoBuffer::CopyPicture(YuvImage* pDst, YuvImage *pSrc)
 {
-  uint8_t *s = pSrc->plane[0];
-  uint8_t *d = pDst->plane[0];
-  int w = pDst->width;
+  int w = pDst->width * pDst->bpp;
   int h = pDst->height;
+  CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0], w, h);
+
+  w = (pDst->width  >> pDst->cshift_x) * pDst->bpp;
+  h = (pDst->height >> pDst->cshift_y);
+  CopyPlane(pDst->plane[1], pDst->stride[1], pSrc->plane[1], pSrc->stride[1], w, h);
+  CopyPlane(pDst->plane[2], pDst->stride[2], pSrc->plane[2], pSrc->stride[2], w, h);
+  return true;
+}
+
+
+bool CVideoBuffer::CopyNV12Picture(YuvImage* pDst, YuvImage *pSrc)
+{
+  // Copy Y
+  CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0], pDst->width,
+            pDst->height);
+
+  // Copy packed UV (width is same as for Y as it's both U and V components)
+  CopyPlane(pDst->plane[1], pDst->stride[1], pSrc->plane[1], pSrc->stride[1], pDst->width,
+            pDst->height >> 1);
 
+  return true;
+}
+
+bool CVideoBuffer::CopyYUV422PackedPicture(YuvImage* pDst, YuvImage *pSrc)
+{
   // Copy YUYV
-  if ((w * 2 == pSrc->stride[0]) && (pSrc->stride[0] == pDst->stride[0]))
-  {
-    memcpy(d, s, w*h*2);
-  }
-  else
-  {
-    for (int y = 0; y < h; y++)
-    {
-      memcpy(d, s, w*2);
-      s += pSrc->stride[0];
-      d += pDst->stride[0];
-    }
-  }
+  CopyPlane(pDst->plane[0], pDst->stride[0], pSrc->plane[0], pSrc->stride[0], pDst->width * 2,
+            pDst->height);
 
   return true;
 }
@@ -560,6 +560,91 @@ int CSelectionStreams::CountType(StreamType type) const
     [&](const SelectionStream& stream) {return stream.type == type;});
 }
 
+//------------------------------------------------------------------------------
+// pre-opened next item
+//------------------------------------------------------------------------------
+
+class CPreOpenedItem
+{
+public:
+  explicit CPreOpenedItem(const CFileItem& item) : m_item(item), m_openedEvent(true) {}
+
+  static bool CanPreOpen(const CFileItem& item)
+  {
+    return !item.IsDiscImage() && !item.IsDVDFile() && !item.IsBDFile() && !item.IsStack() &&
+           !item.IsPVR() && !item.IsLiveTV();
+  }
+
+  const CFileItem& GetItem() const { return m_item; }
+
+  void Open(IVideoPlayer* player)
+  {
+    std::shared_ptr<CDVDInputStream> inputStream =
+        CDVDFactoryInputStream::CreateInputStream(player, m_item, true);
+
+    // other inputs talk back to the player, which is still busy with the current item
+    if (inputStream && !inputStream->IsStreamType(DVDSTREAM_TYPE_FILE) &&
+        !inputStream->IsStreamType(DVDSTREAM_TYPE_FFMPEG) &&
+        !inputStream->IsStreamType(DVDSTREAM_TYPE_MULTIFILES))
+      inputStream.reset();
+
+    {
+      // let Abort() interrupt a slow open
+      CSingleLock lock(m_section);
+      if (m_bAbort)
+        inputStream.reset();
+      m_pOpeningStream = inputStream;
+    }
+
+    std::unique_ptr<CDVDDemux> demuxer;
+    if (inputStream && inputStream->Open())
+      demuxer.reset(CDVDFactoryDemuxer::CreateDemuxer(inputStream));
+
+    CSingleLock lock(m_section);
+    m_pOpeningStream.reset();
+    if (demuxer && !m_bAbort)
+    {
+      m_pInputStream = inputStream;
+      m_pDemuxer = std::move(demuxer);
+    }
+    m_openedEvent.Set();
+  }
+
+  void Abort()
+  {
+    CSingleLock lock(m_section);
+    m_bAbort = true;
+    if (m_pOpeningStream)
+      m_pOpeningStream->Abort();
+    m_pDemuxer.reset();
+    m_pInputStream.reset();
+    m_openedEvent.Set();
+  }
+
+  bool Take(std::shared_ptr<CDVDInputStream>& inputStream, std::unique_ptr<CDVDDemux>& demuxer)
+  {
+    // don't wait forever for a stalled open, the caller can still open the item itself
+    m_openedEvent.WaitMSec(10000);
+
+    CSingleLock lock(m_section);
+    if (!m_pDemuxer)
+      return false;
+
+    inputStream = std::move(m_pInputStream);
+    demuxer = std::move(m_pDemuxer);
+    return true;
+  }
+
+private:
+  const CFileItem m_item;
+  CCriticalSection m_section;
+  CEvent m_openedEvent;
+  bool m_bAbort = false;
+  std::shared_ptr<CDVDInputStream> m_pOpeningStream;
+  std::shared_ptr<CDVDInputStream> m_pInputStream;
+  std::unique_ptr<CDVDDemux> m_pDemuxer;
+};
+
 //------------------------------------------------------------------------------
 // main class
 //------------------------------------------------------------------------------
@@ -677,6 +762,7 @@ bool CVideoPlayer::OpenFile(const CFileItem& file, const CPlayerOptions &options
   m_bAbortRequest = false;
   m_error = false;
   m_bCloseRequest = false;
+  DiscardNextItem();
   m_renderManager.PreInit();
 
   Create();
@@ -717,6 +803,17 @@ bool CVideoPlayer::CloseFile(bool reopen)
     StopThread();
   }
 
+  DiscardNextItem();
+  m_pPreOpenedDemuxer.reset();
+
+  // aborted pre-opens still use this player until their job has finished. the last job sets the
+  // event while holding the lock, so it's done with the player once the lock can be taken
+  {
+    CSingleExit exitlock(CServiceBroker::GetWinSystem()->GetGfxContext());
+    m_preOpenJobsDone.Wait();
+    CSingleLock lock(m_nextItemSection);
+  }
+
   m_Edl.Clear();
   CServiceBroker::GetDataCacheCore().SetCutList(m_Edl.GetCutList());
 
@@ -743,6 +840,71 @@ void CVideoPlayer::OnStartup()
   CUtil::ClearTempFonts();
 }
 
+bool CVideoPlayer::QueueNextFile(const CFileItem &file)
+{
+  CLog::Log(LOGNOTICE, "VideoPlayer::QueueNextFile: %s", CURL::GetRedacted(file.GetPath()).c_str());
+
+  std::shared_ptr<CPreOpenedItem> nextItem = std::make_shared<CPreOpenedItem>(file);
+  if (CPreOpenedItem::CanPreOpen(file))
+  {
+    {
+      // the job uses this player, CloseFile() waits for it
+      CSingleLock lock(m_nextItemSection);
+      if (m_preOpenJobs++ == 0)
+        m_preOpenJobsDone.Reset();
+    }
+
+    CJobManager::GetInstance().Submit([this, nextItem]() {
+      nextItem->Open(this);
+
+      CSingleLock lock(m_nextItemSection);
+      if (--m_preOpenJobs == 0)
+        m_preOpenJobsDone.Set();
+    }, CJob::PRIORITY_NORMAL);
+  }
+  else
+  {
+    // nothing to prepare, but switch over without closing the renderer anyway
+    nextItem->Abort();
+  }
+
+  CSingleLock lock(m_nextItemSection);
+  if (m_nextItem)
+    m_nextItem->Abort();
+  m_nextItem = nextItem;
+
+  return true;
+}
+
+bool CVideoPlayer::OpenNextItem()
+{
+  CSingleLock lock(m_nextItemSection);
+  if (!m_nextItem)
+    return false;
+
+  CLog::Log(LOGNOTICE, "VideoPlayer: switching to next item %s",
+            CURL::GetRedacted(m_nextItem->GetItem().GetPath()).c_str());
+
+  CDVDMsgOpenFile::FileParams params;
+  params.m_item = m_nextItem->GetItem();
+  params.m_options.fullscreen = m_playerOptions.fullscreen;
+  params.m_item.SetMimeTypeForInternetFile();
+  m_messenger.Put(new CDVDMsgOpenFile(params), 1);
+
+  return true;
+}
+
+void CVideoPlayer::DiscardNextItem()
+{
+  CSingleLock lock(m_nextItemSection);
+  if (m_nextItem)
+  {
+    m_nextItem->Abort();
+    m_nextItem.reset();
+  }
+  m_nextItemRequested = false;
+}
+
 bool CVideoPlayer::OpenInputStream()
 {
   if (m_pInputStream.use_count() > 1)
@@ -759,17 +921,35 @@ bool CVideoPlayer::OpenInputStream()
     m_item.SetPath(CServiceBroker::GetMediaManager().TranslateDevicePath(""));
   }
 
-  m_pInputStream = CDVDFactoryInputStream::CreateInputStream(this, m_item, true);
-  if (m_pInputStream == nullptr)
+  // use the input stream and demuxer opened while the previous item was playing, if any
+  std::shared_ptr<CPreOpenedItem> nextItem;
   {
-    CLog::Log(LOGERROR, "CVideoPlayer::OpenInputStream - unable to create input stream for [%s]", CURL::GetRedacted(m_item.GetPath()).c_str());
-    return false;
+    CSingleLock lock(m_nextItemSection);
+    nextItem.swap(m_nextItem);
   }
-
-  if (!m_pInputStream->Open())
+  m_pPreOpenedDemuxer.reset();
+  if (nextItem && nextItem->GetItem().IsSamePath(&m_item) &&
+      nextItem->Take(m_pInputStream, m_pPreOpenedDemuxer))
   {
-    CLog::Log(LOGERROR, "CVideoPlayer::OpenInputStream - error opening [%s]", CURL::GetRedacted(m_item.GetPath()).c_str());
-    return false;
+    CLog::Log(LOGNOTICE, "Using pre-opened InputStream");
+  }
+  else
+  {
+    if (nextItem)
+      nextItem->Abort();
+
+    m_pInputStream = CDVDFactoryInputStream::CreateInputStream(this, m_item, true);
+    if (m_pInputStream == nullptr)
+    {
+      CLog::Log(LOGERROR, "CVideoPlayer::OpenInputStream - unable to create input stream for [%s]", CURL::GetRedacted(m_item.GetPath()).c_str());
+      return false;
+    }
+
+    if (!m_pInputStream->Open())
+    {
+      CLog::Log(LOGERROR, "CVideoPlayer::OpenInputStream - error opening [%s]", CURL::GetRedacted(m_item.GetPath()).c_str());
+      return false;
+    }
   }
 
   // find any available external subtitles for non dvd files
@@ -817,6 +997,12 @@ bool CVideoPlayer::OpenDemuxStream()
   CLog::Log(LOGNOTICE, "Creating Demuxer");
 
   int attempts = 10;
+  if (m_pPreOpenedDemuxer)
+  {
+    m_pDemuxer = m_pPreOpenedDemuxer.release();
+    attempts = 0;
+  }
+
   while (!m_bStop && attempts-- > 0)
   {
     m_pDemuxer = CDVDFactoryDemuxer::CreateDemuxer(m_pInputStream);
@@ -1487,6 +1673,17 @@ void CVideoPlayer::Process()
       // if we are caching, start playing it again
       SetCaching(CACHESTATE_DONE);
 
+      // ask for the next playlist item, it can be opened while the players drain
+      if (!m_nextItemRequested &&
+          CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_videoPreOpenNextItem &&
+          !std::dynamic_pointer_cast<CDVDInputStream::IMenus>(m_pInputStream))
+      {
+        m_nextItemRequested = true;
+        m_outboundEvents->Submit([this]() {
+          m_callback.OnQueueNextItem();
+        });
+      }
+
       // while players are still playing, keep going to allow seekbacks
       if (m_VideoPlayerAudio->HasData() ||
           m_VideoPlayerVideo->HasData())
@@ -1498,6 +1695,10 @@ void CVideoPlayer::Process()
       if (!m_pInputStream->IsEOF())
         CLog::Log(LOGINFO, "%s - eof reading from demuxer", __FUNCTION__);
 
+      // switch over to the queued item without closing the renderer
+      if (OpenNextItem())
+        continue;
+
       break;
     }
 
@@ -2492,6 +2693,7 @@ void CVideoPlayer::HandleMessages()
 
       m_item = msg.GetItem();
       m_playerOptions = msg.GetOptions();
+      m_nextItemRequested = false;
 
       m_processInfo->SetPlayTimes(0,0,0,0);
 
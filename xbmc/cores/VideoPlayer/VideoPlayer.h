@@ -96,6 +96,7 @@ class CDemuxStreamAudio;
 class CStreamInfo;
 class CDVDDemuxCC;
 class CVideoPlayer;
+class CPreOpenedItem;
 
 #define DVDSTATE_NORMAL           0x00000001 // normal dvd state
 #define DVDSTATE_STILL            0x00000002 // currently displaying a still frame
@@ -241,6 +242,7 @@ public:
   ~CVideoPlayer() override;
   bool OpenFile(const CFileItem& file, const CPlayerOptions &options) override;
   bool CloseFile(bool reopen = false) override;
+  bool QueueNextFile(const CFileItem &file) override;
   bool IsPlaying() const override;
   void Pause() override;
   bool HasVideo() const override;
@@ -424,6 +426,8 @@ protected:
   bool OpenInputStream();
   bool OpenDemuxStream();
   void CloseDemuxer();
+  bool OpenNextItem();
+  void DiscardNextItem();
   void OpenDefaultStreams(bool reset = true);
 
   void UpdatePlayState(double timeout);
@@ -501,6 +505,14 @@ protected:
   std::unordered_map<int64_t, std::shared_ptr<CDVDDemux>> m_subtitleDemuxerMap;
   CDVDDemuxCC* m_pCCDemuxer;
 
+  // upcoming playlist item, opened while the current one drains
+  CCriticalSection m_nextItemSection;
+  std::shared_ptr<CPreOpenedItem> m_nextItem;
+  std::unique_ptr<CDVDDemux> m_pPreOpenedDemuxer;
+  bool m_nextItemRequested = false;
+  int m_preOpenJobs = 0; ///< number of pre-open jobs still running, they use this player
+  CEvent m_preOpenJobsDone{true, true}; ///< set while no pre-open job is running
+
   CRenderManager m_renderManager;
 
   struct SDVDInfo
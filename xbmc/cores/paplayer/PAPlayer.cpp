@@ -16,6 +16,7 @@
 #include "cores/AudioEngine/Utils/AEStreamData.h"
 #include "cores/AudioEngine/Utils/AEUtil.h"
 #include "cores/DataCacheCore.h"
+#include "cores/VideoPlayer/DVDCodecs/DVDFactoryCodec.h"
 #include "cores/VideoPlayer/Process/ProcessInfo.h"
 #include "music/tags/MusicInfoTag.h"
 #include "settings/AdvancedSettings.h"
@@ -56,6 +57,7 @@ PAPlayer::PAPlayer(IPlayerCallback& callback) :
 PAPlayer::~PAPlayer()
 {
   CloseFile();
+  CDVDFactoryCodec::ClearAudioCodecPool();
 }
 
 bool PAPlayer::HandlesType(const std::string &type)
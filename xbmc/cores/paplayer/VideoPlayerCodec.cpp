@@ -158,11 +158,14 @@ bool VideoPlayerCodec::Init(const CFileItem &file, unsigned int filecache)
     return false;
   }
 
-  CDVDStreamInfo hint(*pStream, true);
+  m_hint = CDVDStreamInfo(*pStream, true);
 
-  CAEStreamInfo::DataType ptStreamTye =
-      GetPassthroughStreamType(hint.codec, hint.samplerate, hint.profile);
-  m_pAudioCodec = CDVDFactoryCodec::CreateAudioCodec(hint, *m_processInfo, true, true, ptStreamTye);
+  m_ptStreamType = GetPassthroughStreamType(m_hint.codec, m_hint.samplerate, m_hint.profile);
+  m_pAudioCodec = CDVDFactoryCodec::AcquireAudioCodec(m_hint, m_processInfo, true, true,
+                                                      m_ptStreamType).release();
+  if (!m_pAudioCodec)
+    m_pAudioCodec = CDVDFactoryCodec::CreateAudioCodec(m_hint, *m_processInfo, true, true,
+                                                       m_ptStreamType);
   if (!m_pAudioCodec)
   {
     CLog::Log(LOGERROR, "%s: Could not create audio codec", __FUNCTION__);
@@ -300,8 +303,12 @@ void VideoPlayerCodec::DeInit()
 
   if (m_pAudioCodec != NULL)
   {
-    delete m_pAudioCodec;
+    // keep the codec around for the next item, the process info goes along with it
+    CDVDFactoryCodec::ReleaseAudioCodec(std::unique_ptr<CDVDAudioCodec>(m_pAudioCodec),
+                                        std::move(m_processInfo), m_hint, true, true,
+                                        m_ptStreamType);
     m_pAudioCodec = NULL;
+    m_processInfo.reset(CProcessInfo::CreateInstance());
   }
 
   delete m_pResampler;
@@ -12,6 +12,7 @@
 #include "cores/VideoPlayer/DVDCodecs/Audio/DVDAudioCodec.h"
 #include "cores/VideoPlayer/DVDDemuxers/DVDDemux.h"
 #include "cores/VideoPlayer/DVDInputStreams/DVDInputStream.h"
+#include "cores/VideoPlayer/DVDStreamInfo.h"
 
 namespace ActiveAE
 {
@@ -60,6 +61,8 @@ private:
   AEAudioFormat m_srcFormat;
   int m_channels;
 
+  CDVDStreamInfo m_hint;
+  CAEStreamInfo::DataType m_ptStreamType = CAEStreamInfo::STREAM_TYPE_NULL;
   std::unique_ptr<CProcessInfo> m_processInfo;
 };
 
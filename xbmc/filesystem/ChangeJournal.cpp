@@ -0,0 +1,437 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "ChangeJournal.h"
+
+#include "URL.h"
+#include "filesystem/SpecialProtocol.h"
+#include "threads/SingleLock.h"
+#include "utils/URIUtils.h"
+#include "utils/log.h"
+
+#if defined(TARGET_LINUX)
+#include <dirent.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
+
+using namespace XFILE;
+
+#if defined(TARGET_LINUX)
+namespace
+{
+constexpr uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                                IN_ONLYDIR;
+
+// file systems whose content can change without the local kernel knowing
+bool IsRemoteFileSystem(const char* path)
+{
+  static const unsigned long remoteTypes[] = {
+    0x6969, // NFS
+    0x517B, // SMB
+    0xFF534D42, // CIFS
+    0xFE534D42, // SMB2
+    0x65735546, // FUSE
+    0x73757245, // CODA
+    0x5346414F, // AFS
+    0x00C36400, // CEPH
+    0x01021997, // 9P
+    0x47504653, // GPFS
+  };
+
+  struct statfs fs;
+  if (statfs(path, &fs) != 0)
+    return true;
+
+  const unsigned long type = static_cast<unsigned long>(fs.f_type) & 0xFFFFFFFF;
+  for (const auto remoteType : remoteTypes)
+  {
+    if (type == remoteType)
+      return true;
+  }
+  return false;
+}
+}
+#endif
+
+CChangeJournal& CChangeJournal::GetInstance()
+{
+  // never destroyed, the watcher thread may still run while statics are torn down
+  static CChangeJournal* journal = new CChangeJournal();
+  return *journal;
+}
+
+CChangeJournal::CChangeJournal()
+  : CThread("ChangeJournal")
+{
+}
+
+CChangeJournal::~CChangeJournal()
+{
+  StopThread();
+#if defined(TARGET_LINUX)
+  if (m_fd >= 0)
+    close(m_fd);
+#endif
+}
+
+std::string CChangeJournal::GetLocalPath(const std::string& path)
+{
+  std::string localPath = path;
+  if (URIUtils::IsSpecial(localPath))
+    localPath = CSpecialProtocol::TranslatePath(localPath);
+
+  // anything else than an absolute path is a protocol we can't watch
+  if (localPath.empty() || localPath[0] != '/')
+    return "";
+
+  URIUtils::AddSlashAtEnd(localPath);
+  return localPath;
+}
+
+bool CChangeJournal::Watch(const std::string& path)
+{
+#if defined(TARGET_LINUX)
+  const std::string dir = GetLocalPath(path);
+  if (dir.empty())
+    return false;
+
+  // a tree that was removed or replaced may still be listed
+  ReadEvents();
+
+  // no events are read until the new watches are known
+  CSingleLock readLock(m_readSection);
+  int fd;
+  {
+    CSingleLock lock(m_critSection);
+    if (IsWatched(dir))
+      return true;
+    if (m_failed.find(dir) != m_failed.end())
+      return false;
+
+    if (m_fd < 0)
+    {
+      m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (m_fd < 0)
+      {
+        CLog::Log(LOGWARNING, "CChangeJournal::%s - inotify unavailable: %s", __FUNCTION__, strerror(errno));
+        m_failed.insert(dir);
+        return false;
+      }
+    }
+    fd = m_fd;
+  }
+
+  std::vector<std::pair<int, std::string>> added;
+  const bool watched = AddWatches(fd, dir, added);
+
+  {
+    CSingleLock lock(m_critSection);
+    if (!watched)
+    {
+      for (const auto& watch : added)
+      {
+        if (m_watches.find(watch.first) == m_watches.end())
+          inotify_rm_watch(m_fd, watch.first);
+      }
+      CLog::Log(LOGINFO, "CChangeJournal::%s - changes in '%s' can't be tracked, it will be hashed", __FUNCTION__, CURL::GetRedacted(dir).c_str());
+      m_failed.insert(dir);
+      return false;
+    }
+
+    for (const auto& watch : added)
+      m_watches[watch.first] = watch.second;
+    m_roots.insert(dir);
+    CLog::Log(LOGDEBUG, "CChangeJournal::%s - tracking changes in '%s' (%u directories watched)", __FUNCTION__, CURL::GetRedacted(dir).c_str(), static_cast<unsigned int>(m_watches.size()));
+  }
+
+  if (!IsRunning())
+    Create();
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t CChangeJournal::GetSequence()
+{
+#if defined(TARGET_LINUX)
+  ReadEvents();
+#endif
+  CSingleLock lock(m_critSection);
+  return m_sequence;
+}
+
+bool CChangeJournal::IsUnchanged(const std::string& path)
+{
+  const std::string dir = GetLocalPath(path);
+  if (dir.empty())
+    return false;
+
+#if defined(TARGET_LINUX)
+  // pick up what happened since the watcher thread last looked
+  ReadEvents();
+#endif
+
+  CSingleLock lock(m_critSection);
+
+  // the tree is unchanged if it or any of its parents is still clean
+  for (size_t pos = dir.find('/'); pos != std::string::npos; pos = dir.find('/', pos + 1))
+  {
+    if (m_clean.find(dir.substr(0, pos + 1)) != m_clean.end())
+      return true;
+  }
+  return false;
+}
+
+void CChangeJournal::MarkClean(const std::string& path, uint64_t sequence)
+{
+  const std::string dir = GetLocalPath(path);
+  if (dir.empty())
+    return;
+
+#if defined(TARGET_LINUX)
+  ReadEvents();
+#endif
+
+  CSingleLock lock(m_critSection);
+  if (sequence != m_sequence || !IsWatched(dir))
+    return;
+
+  m_clean.insert(dir);
+}
+
+void CChangeJournal::MarkChanged(const std::string& path)
+{
+  const std::string dir = GetLocalPath(path);
+  if (dir.empty())
+    return;
+
+  CSingleLock lock(m_critSection);
+  Invalidate(dir);
+}
+
+bool CChangeJournal::IsWatched(const std::string& dir) const
+{
+  for (size_t pos = dir.find('/'); pos != std::string::npos; pos = dir.find('/', pos + 1))
+  {
+    if (m_roots.find(dir.substr(0, pos + 1)) != m_roots.end())
+      return true;
+  }
+  return false;
+}
+
+void CChangeJournal::Invalidate(const std::string& dir)
+{
+  m_sequence++;
+  for (size_t pos = dir.find('/'); pos != std::string::npos; pos = dir.find('/', pos + 1))
+    m_clean.erase(dir.substr(0, pos + 1));
+}
+
+void CChangeJournal::RemoveRoot(const std::string& dir)
+{
+  for (auto it = m_roots.begin(); it != m_roots.end();)
+  {
+    const std::string root = *it;
+    if (!URIUtils::PathHasParent(dir, root))
+    {
+      ++it;
+      continue;
+    }
+
+    CLog::Log(LOGDEBUG, "CChangeJournal::%s - no longer tracking changes in '%s'", __FUNCTION__, CURL::GetRedacted(root).c_str());
+    it = m_roots.erase(it);
+
+    for (auto clean = m_clean.begin(); clean != m_clean.end();)
+    {
+      if (URIUtils::PathHasParent(*clean, root))
+        clean = m_clean.erase(clean);
+      else
+        ++clean;
+    }
+
+#if defined(TARGET_LINUX)
+    for (auto watch = m_watches.begin(); watch != m_watches.end();)
+    {
+      if (URIUtils::PathHasParent(watch->second, root) && !IsWatched(watch->second))
+      {
+        inotify_rm_watch(m_fd, watch->first);
+        watch = m_watches.erase(watch);
+      }
+      else
+        ++watch;
+    }
+#endif
+  }
+}
+
+void CChangeJournal::Process()
+{
+#if defined(TARGET_LINUX)
+  while (!m_bStop)
+  {
+    // drain the queue regularly, the kernel drops events once it's full
+    struct pollfd pfd = { m_fd, POLLIN, 0 };
+    if (poll(&pfd, 1, 500) > 0)
+      ReadEvents();
+  }
+#endif
+}
+
+#if defined(TARGET_LINUX)
+bool CChangeJournal::AddWatches(int fd, const std::string& dir, std::vector<std::pair<int, std::string>>& added)
+{
+  std::vector<std::string> pending{ dir };
+  while (!pending.empty())
+  {
+    const std::string current = pending.back();
+    pending.pop_back();
+
+    if (IsRemoteFileSystem(current.c_str()))
+      return false;
+
+    const int wd = inotify_add_watch(fd, current.c_str(), WATCH_MASK);
+    if (wd < 0)
+    {
+      CLog::Log(LOGWARNING, "CChangeJournal::%s - unable to watch '%s': %s", __FUNCTION__, CURL::GetRedacted(current).c_str(), strerror(errno));
+      return false;
+    }
+    added.emplace_back(wd, current);
+
+    DIR* handle = opendir(current.c_str());
+    if (!handle)
+      return false;
+
+    bool ok = true;
+    while (struct dirent* entry = readdir(handle))
+    {
+      if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+        continue;
+
+      const std::string entryPath = current + entry->d_name;
+      unsigned char type = entry->d_type;
+      if (type == DT_UNKNOWN)
+      {
+        struct stat st;
+        if (lstat(entryPath.c_str(), &st) != 0)
+          continue;
+        type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : DT_REG;
+      }
+
+      if (type == DT_DIR)
+        pending.push_back(entryPath + "/");
+      else if (type == DT_LNK)
+      {
+        // linked directories are scanned but lead out of the watched tree
+        struct stat st;
+        if (stat(entryPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+        {
+          ok = false;
+          break;
+        }
+      }
+    }
+    closedir(handle);
+
+    if (!ok)
+      return false;
+  }
+  return true;
+}
+
+void CChangeJournal::ReadEvents()
+{
+  // one reader at a time, or events of new directories could be read before their watches are
+  // known. Only the state is protected by m_critSection, the file system is walked without it.
+  CSingleLock readLock(m_readSection);
+
+  std::vector<std::pair<std::string, std::string>> created; // watched parent, new directory
+  std::vector<std::pair<std::string, std::string>> links; // watched parent, new entry
+  int fd;
+  {
+    CSingleLock lock(m_critSection);
+    if (m_fd < 0)
+      return;
+    fd = m_fd;
+
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;)
+    {
+      const ssize_t length = read(m_fd, buffer, sizeof(buffer));
+      if (length <= 0)
+        break;
+
+      for (const char* p = buffer; p < buffer + length;)
+      {
+        const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+        p += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW)
+        {
+          CLog::Log(LOGWARNING, "CChangeJournal::%s - event queue overflow, all directories will be hashed", __FUNCTION__);
+          m_clean.clear();
+          m_sequence++;
+          continue;
+        }
+
+        const auto watch = m_watches.find(event->wd);
+        if (watch == m_watches.end())
+          continue;
+
+        if (event->mask & IN_IGNORED)
+        {
+          m_watches.erase(watch);
+          continue;
+        }
+
+        const std::string dir = watch->second;
+        Invalidate(dir);
+
+        if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0)
+          created.emplace_back(dir, dir + event->name + "/");
+        else if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0)
+          links.emplace_back(dir, dir + event->name);
+        else if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && m_roots.find(dir) != m_roots.end())
+          RemoveRoot(dir);
+      }
+    }
+  }
+
+  // new directories are watched as well, or the tree can't be trusted any more. Walking them
+  // may take a while, so it's done without blocking the library.
+  for (const auto& dirs : created)
+  {
+    std::vector<std::pair<int, std::string>> added;
+    const bool watched = AddWatches(fd, dirs.second, added);
+
+    CSingleLock lock(m_critSection);
+    for (const auto& watch : added)
+      m_watches[watch.first] = watch.second;
+    if (!watched)
+      RemoveRoot(dirs.first);
+  }
+
+  // same goes for links to directories, which lead out of the tree
+  for (const auto& entry : links)
+  {
+    struct stat st;
+    if (lstat(entry.second.c_str(), &st) == 0 && S_ISLNK(st.st_mode) &&
+        stat(entry.second.c_str(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+      CSingleLock lock(m_critSection);
+      RemoveRoot(entry.first);
+    }
+  }
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "threads/CriticalSection.h"
+#include "threads/Thread.h"
+
+#include <map>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace XFILE
+{
+/*!
+ * \brief Journal of changes in local directory trees, fed by inotify on Linux.
+ *
+ * Library scanners use it to skip directories that are known to be unchanged since they were
+ * last scanned, instead of listing and hashing them again. Only trees on local file systems can
+ * be watched: remote protocols and network mounts (NFS, SMB, FUSE, ...) don't report changes
+ * made elsewhere and always have to be hashed. On other platforms nothing is ever watched.
+ *
+ * Usage: Watch() a tree before scanning it, remember GetSequence(), scan, and if everything was
+ * stored in the library call MarkClean() with the remembered sequence. From then on
+ * IsUnchanged() returns true for the tree and its subdirectories until something changes in them,
+ * or MarkChanged() reports a change on the library side.
+ */
+class CChangeJournal : private CThread
+{
+public:
+  static CChangeJournal& GetInstance();
+
+  /*!
+   * \brief Start tracking a directory tree.
+   * \param path the root of the tree
+   * \return true if the whole tree is watched, false if it can't be tracked
+   */
+  bool Watch(const std::string& path);
+
+  /*!
+   * \brief Current position in the journal, increased on every change.
+   */
+  uint64_t GetSequence();
+
+  /*!
+   * \brief Check whether a directory tree is in the state it had when it was marked clean.
+   * \param path directory to check, anywhere inside a watched tree
+   * \return true if nothing changed in it, false if it changed or isn't tracked
+   */
+  bool IsUnchanged(const std::string& path);
+
+  /*!
+   * \brief Record that a directory tree is in sync with the library.
+   * Ignored if anything changed since \p sequence, as the scan may have missed it.
+   * \param path directory that was scanned
+   * \param sequence value of GetSequence() from before the scan started
+   */
+  void MarkClean(const std::string& path, uint64_t sequence);
+
+  /*!
+   * \brief Record a change the file system doesn't report, e.g. library entries of a directory
+   * being invalidated. The directory and its parents are no longer clean.
+   * \param path directory that changed
+   */
+  void MarkChanged(const std::string& path);
+
+protected:
+  void Process() override;
+
+private:
+  CChangeJournal();
+  ~CChangeJournal() override;
+
+  static std::string GetLocalPath(const std::string& path);
+  bool IsWatched(const std::string& dir) const;
+  void Invalidate(const std::string& dir);
+  void RemoveRoot(const std::string& dir);
+
+#if defined(TARGET_LINUX)
+  static bool AddWatches(int fd, const std::string& dir, std::vector<std::pair<int, std::string>>& added);
+  void ReadEvents();
+
+  int m_fd = -1;
+  std::map<int, std::string> m_watches; // watch descriptor -> directory
+#endif
+
+  std::set<std::string> m_roots; // completely watched trees
+  std::set<std::string> m_failed; // trees that can't be watched, not tried again
+  std::set<std::string> m_clean; // trees in sync with the library
+  uint64_t m_sequence = 0;
+  CCriticalSection m_critSection;
+  CCriticalSection m_readSection; // held while events are read and directories are added
+};
+}
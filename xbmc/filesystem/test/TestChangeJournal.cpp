@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "filesystem/ChangeJournal.h"
+#include "filesystem/Directory.h"
+#include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
+
+#include <gtest/gtest.h>
+
+class TestChangeJournal : public testing::Test
+{
+protected:
+  TestChangeJournal()
+  {
+    m_root = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"),
+                                       "TestChangeJournal");
+    URIUtils::AddSlashAtEnd(m_root);
+    m_subdir = URIUtils::AddFileToFolder(m_root, "subdir");
+    URIUtils::AddSlashAtEnd(m_subdir);
+    XFILE::CDirectory::RemoveRecursive(m_root);
+    XFILE::CDirectory::Create(m_subdir);
+  }
+
+  ~TestChangeJournal() override
+  {
+    XFILE::CDirectory::RemoveRecursive(m_root);
+  }
+
+  bool CreateFile(const std::string& path)
+  {
+    XFILE::CFile file;
+    return file.OpenForWrite(path, true) && file.Write("data", 4) == 4;
+  }
+
+  std::string m_root;
+  std::string m_subdir;
+};
+
+TEST_F(TestChangeJournal, NewFile)
+{
+  XFILE::CChangeJournal& journal = XFILE::CChangeJournal::GetInstance();
+  ASSERT_TRUE(journal.Watch(m_root));
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+
+  journal.MarkClean(m_root, journal.GetSequence());
+  EXPECT_TRUE(journal.IsUnchanged(m_root));
+  EXPECT_TRUE(journal.IsUnchanged(m_subdir));
+
+  ASSERT_TRUE(CreateFile(URIUtils::AddFileToFolder(m_subdir, "movie.mkv")));
+  EXPECT_FALSE(journal.IsUnchanged(m_subdir));
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+}
+
+TEST_F(TestChangeJournal, StaleSequence)
+{
+  XFILE::CChangeJournal& journal = XFILE::CChangeJournal::GetInstance();
+  ASSERT_TRUE(journal.Watch(m_root));
+
+  // a change during the scan keeps the tree from being marked clean
+  const uint64_t sequence = journal.GetSequence();
+  ASSERT_TRUE(CreateFile(URIUtils::AddFileToFolder(m_root, "movie.mkv")));
+  journal.MarkClean(m_root, sequence);
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+}
+
+TEST_F(TestChangeJournal, NewDirectory)
+{
+  XFILE::CChangeJournal& journal = XFILE::CChangeJournal::GetInstance();
+  ASSERT_TRUE(journal.Watch(m_root));
+
+  std::string newDir = URIUtils::AddFileToFolder(m_subdir, "new");
+  URIUtils::AddSlashAtEnd(newDir);
+  ASSERT_TRUE(XFILE::CDirectory::Create(newDir));
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+
+  // new directories are watched as well
+  journal.MarkClean(m_root, journal.GetSequence());
+  EXPECT_TRUE(journal.IsUnchanged(newDir));
+  ASSERT_TRUE(CreateFile(URIUtils::AddFileToFolder(newDir, "movie.mkv")));
+  EXPECT_FALSE(journal.IsUnchanged(newDir));
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+}
+
+TEST_F(TestChangeJournal, MarkChanged)
+{
+  XFILE::CChangeJournal& journal = XFILE::CChangeJournal::GetInstance();
+  ASSERT_TRUE(journal.Watch(m_root));
+  journal.MarkClean(m_root, journal.GetSequence());
+  EXPECT_TRUE(journal.IsUnchanged(m_subdir));
+
+  // invalidated in the library, the directory and its parents are no longer clean
+  journal.MarkChanged(m_subdir);
+  EXPECT_FALSE(journal.IsUnchanged(m_subdir));
+  EXPECT_FALSE(journal.IsUnchanged(m_root));
+}
+
+TEST_F(TestChangeJournal, Remote)
+{
+  EXPECT_FALSE(XFILE::CChangeJournal::GetInstance().Watch("smb://server/share/"));
+  EXPECT_FALSE(XFILE::CChangeJournal::GetInstance().IsUnchanged("smb://server/share/"));
+}
@@ -9,13 +9,16 @@
 #include "GUIBaseContainer.h"
 
 #include "FileItem.h"
+#include "GUIComponent.h"
 #include "GUIInfoManager.h"
 #include "GUIListItemLayout.h"
 #include "GUIMessage.h"
 #include "ServiceBroker.h"
+#include "GUILargeTextureManager.h"
 #include "guilib/guiinfo/GUIInfoLabels.h"
 #include "input/Key.h"
 #include "listproviders/IListProvider.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "utils/CharsetConverter.h"
@@ -30,6 +33,7 @@
 #define HOLD_TIME_END   3000
 #define SCROLLING_GAP   200U
 #define SCROLLING_THRESHOLD 300U
+#define PREFETCH_LOOKAHEAD_TIME 1000U
 
 CGUIBaseContainer::CGUIBaseContainer(int parentID, int controlID, float posX, float posY, float width, float height, ORIENTATION orientation, const CScroller& scroller, int preloadItems)
     : IGUIContainer(parentID, controlID, posX, posY, width, height)
@@ -63,6 +67,9 @@ CGUIBaseContainer::~CGUIBaseContainer(void)
   for (auto item : m_items)
     item->FreeMemory();
 
+  if (CServiceBroker::GetGUI())
+    CServiceBroker::GetGUI()->GetLargeTextureManager().ReleasePrefetchedImages(this);
+
   delete m_listProvider;
 }
 
@@ -143,6 +150,8 @@ void CGUIBaseContainer::Process(unsigned int currentTime, CDirtyRegionList &dirt
   // to have same behaviour when scrolling down, we need to set page control to offset+1
   UpdatePageControl(offset + (m_scroller.IsScrollingDown() ? 1 : 0));
 
+  UpdatePrefetch(offset, cacheBefore, cacheAfter, currentTime);
+
   m_lastRenderTime = currentTime;
 
   CGUIControl::Process(currentTime, dirtyregions);
@@ -871,6 +880,7 @@ void CGUIBaseContainer::FreeResources(bool immediately)
     }
   }
   m_scroller.Stop();
+  ResetPrefetch();
 }
 
 void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
@@ -884,6 +894,9 @@ void CGUIBaseContainer::UpdateLayout(bool updateAllItems)
   CalculateLayout();
   SetPageControlRange();
   MarkDirtyRegion();
+  // layouts may show different art now
+  m_prefetchArtTypes.clear();
+  m_prefetchOffset = -1;
 }
 
 void CGUIBaseContainer::SetPageControlRange()
@@ -1145,6 +1158,7 @@ void CGUIBaseContainer::Reset()
   m_items.clear();
   m_lastItem.reset();
   ResetAutoScrolling();
+  ResetPrefetch();
 }
 
 void CGUIBaseContainer::LoadLayout(TiXmlElement *layout)
@@ -1367,6 +1381,98 @@ void CGUIBaseContainer::GetCacheOffsets(int &cacheBefore, int &cacheAfter) const
   }
 }
 
+void CGUIBaseContainer::UpdatePrefetch(int offset, int cacheBefore, int cacheAfter, unsigned int currentTime)
+{
+  const int pages = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_guiPrefetchPages;
+  if (pages <= 0 || m_items.empty())
+    return;
+
+  // estimate how fast we're scrolling, in rows per second
+  if (m_prefetchTime && currentTime > m_prefetchTime && m_prefetchOffset >= 0)
+  {
+    float velocity = (offset - m_prefetchOffset) * 1000.0f / (currentTime - m_prefetchTime);
+    m_prefetchVelocity = 0.8f * m_prefetchVelocity + 0.2f * velocity;
+  }
+  m_prefetchTime = currentTime;
+
+  int direction = ScrollingDown() ? 1 : (ScrollingUp() ? -1 : 0);
+  if (offset == m_prefetchOffset && direction == m_prefetchDirection)
+    return;
+  m_prefetchOffset = offset;
+  m_prefetchDirection = direction;
+
+  // find out which art our layouts actually show by checking which of the art of the processed
+  // items has been requested from the large texture manager
+  CGUILargeTextureManager &textureManager = CServiceBroker::GetGUI()->GetLargeTextureManager();
+  if (m_prefetchArtTypes.empty())
+  {
+    for (int row = offset - cacheBefore; row < offset + m_itemsPerPage + cacheAfter; row++)
+    {
+      int itemNo = CorrectOffset(row, 0);
+      if (itemNo < 0 || itemNo >= static_cast<int>(m_items.size()))
+        continue;
+      for (const auto &art : m_items[itemNo]->GetArt())
+      {
+        if (!art.second.empty() && textureManager.IsImageRequested(art.second))
+          m_prefetchArtTypes.insert(art.first);
+      }
+    }
+    if (m_prefetchArtTypes.empty())
+      return;
+  }
+
+  // prefetch further ahead the faster we scroll, and only a single page behind when moving
+  int rowsAhead = m_itemsPerPage * pages;
+  int rowsBehind = direction ? m_itemsPerPage : m_itemsPerPage * pages;
+  rowsAhead = std::max(rowsAhead, static_cast<int>(std::abs(m_prefetchVelocity) * PREFETCH_LOOKAHEAD_TIME / 1000));
+  rowsAhead = std::min(rowsAhead, m_itemsPerPage * pages * 4);
+
+  int firstAhead = offset + m_itemsPerPage + cacheAfter;
+  int firstBehind = offset - cacheBefore - 1;
+  if (direction < 0)
+    std::swap(rowsAhead, rowsBehind);
+
+  // closest rows first, alternating between below and above the visible area
+  std::vector<std::string> paths;
+  const int lastItem = static_cast<int>(m_items.size());
+  const int itemsPerRow = std::max(1, CorrectOffset(1, 0) - CorrectOffset(0, 0));
+  auto addRow = [&](int row)
+  {
+    int first = CorrectOffset(row, 0);
+    for (int itemNo = first; itemNo < first + itemsPerRow; itemNo++)
+    {
+      if (itemNo < 0 || itemNo >= lastItem)
+        continue;
+      for (const auto &type : m_prefetchArtTypes)
+      {
+        std::string art = m_items[itemNo]->GetArt(type);
+        if (!art.empty())
+          paths.emplace_back(std::move(art));
+      }
+    }
+  };
+  for (int i = 0; i < std::max(rowsAhead, rowsBehind); i++)
+  {
+    if (i < rowsAhead)
+      addRow(firstAhead + i);
+    if (i < rowsBehind)
+      addRow(firstBehind - i);
+  }
+
+  textureManager.PrefetchImages(this, paths);
+}
+
+void CGUIBaseContainer::ResetPrefetch()
+{
+  if (CServiceBroker::GetGUI())
+    CServiceBroker::GetGUI()->GetLargeTextureManager().ReleasePrefetchedImages(this);
+  m_prefetchArtTypes.clear();
+  m_prefetchVelocity = 0.0f;
+  m_prefetchOffset = -1;
+  m_prefetchDirection = 0;
+  m_prefetchTime = 0;
+}
+
 void CGUIBaseContainer::SetCursor(int cursor)
 {
   if (m_cursor != cursor)
@@ -18,6 +18,8 @@
 #include "utils/Stopwatch.h"
 
 #include <list>
+#include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -168,6 +170,18 @@ protected:
   void UpdateScrollByLetter();
   void GetCacheOffsets(int &cacheBefore, int &cacheAfter) const;
   int GetCacheCount() const { return m_cacheItems; };
+
+  /*! \brief Keep the artwork of items outside the visible area loaded
+   Estimates the scroll velocity and asks the large texture manager to prefetch the artwork of the
+   items in the pages ahead of (and, to a lesser extent, behind) the visible ones, so that scrolling
+   doesn't show blank images while they load.
+   \param offset the first visible row.
+   \param cacheBefore number of rows processed before the visible ones.
+   \param cacheAfter number of rows processed after the visible ones.
+   \param currentTime the current frame time.
+   */
+  void UpdatePrefetch(int offset, int cacheBefore, int cacheAfter, unsigned int currentTime);
+  void ResetPrefetch();
   bool ScrollingDown() const { return m_scroller.IsScrollingDown(); };
   bool ScrollingUp() const { return m_scroller.IsScrollingUp(); };
   void OnNextLetter();
@@ -227,6 +241,13 @@ private:
   float m_scrollItemsPerFrame;
 
   static const int letter_match_timeout = 1000;
+
+  // artwork prefetching
+  std::set<std::string> m_prefetchArtTypes; ///< art types shown by our layouts
+  float m_prefetchVelocity = 0.0f;          ///< smoothed scroll velocity in rows per second
+  int m_prefetchOffset = -1;                ///< offset the prefetch set was last computed for
+  int m_prefetchDirection = 0;              ///< scroll direction the prefetch set was last computed for
+  unsigned int m_prefetchTime = 0;          ///< frame time of the last velocity update
 };
 
 
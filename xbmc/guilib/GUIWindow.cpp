@@ -151,7 +151,21 @@ bool CGUIWindow::LoadXML(const std::string &strPath, const std::string &strLower
   else
     CLog::Log(LOGDEBUG, "Using already stored xml root node for %s", strPath.c_str());
 
-  return Load(Prepare(m_windowXMLRootElement).get());
+  // the prepared xml only depends on the values of the include conditions,
+  // so it can be reused as long as none of them changed
+  if (!m_windowXMLPreparedElement ||
+      CServiceBroker::GetGUI()->GetInfoManager().ConditionsChangedValues(m_xmlIncludeConditions))
+  {
+    m_xmlIncludeConditions.clear();
+    m_windowXMLPreparedElement = Prepare(m_windowXMLRootElement);
+    if (!m_windowXMLPreparedElement)
+      return false;
+  }
+  else
+    CLog::Log(LOGDEBUG, "Using already prepared xml for %s", strPath.c_str());
+
+  auto preparedRoot = std::unique_ptr<TiXmlElement>(static_cast<TiXmlElement*>(m_windowXMLPreparedElement->Clone()));
+  return Load(preparedRoot.get());
 }
 
 std::unique_ptr<TiXmlElement> CGUIWindow::Prepare(TiXmlElement *pRootElement)
@@ -783,6 +797,7 @@ void CGUIWindow::FreeResources(bool forceUnload /*= false */)
   {
     delete m_windowXMLRootElement;
     m_windowXMLRootElement = nullptr;
+    m_windowXMLPreparedElement.reset();
     m_xmlIncludeConditions.clear();
   }
 }
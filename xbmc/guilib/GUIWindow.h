@@ -274,6 +274,7 @@ protected:
   CGUIAction m_unloadActions;
 
   TiXmlElement* m_windowXMLRootElement;
+  std::unique_ptr<TiXmlElement> m_windowXMLPreparedElement; ///< \brief m_windowXMLRootElement with includes resolved
 
   bool m_manualRunActions;
 
@@ -14,6 +14,7 @@
 #include "music/tags/MusicInfoTag.h"
 #include "pvr/channels/PVRChannel.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include "utils/log.h"
@@ -23,8 +24,48 @@
 
 #define LOOKUP_PROPERTY "database-lookup"
 
+// maximum number of queued library updates, further ones are dropped
+#define MAX_QUEUED_LIBRARY_UPDATES 10000
+// number of queued announcements searched for one to merge with
+#define COALESCE_SEARCH_DEPTH 100
+// time library updates are held back to give following ones a chance to be merged
+#define COALESCE_WINDOW 100
+
 using namespace ANNOUNCEMENT;
 
+namespace
+{
+bool IsLibraryAnnouncement(AnnouncementFlag flag)
+{
+  return flag == VideoLibrary || flag == AudioLibrary;
+}
+
+// library updates only tell clients to refresh something, they are the only ones that may be
+// held back or dropped
+bool IsLibraryUpdate(AnnouncementFlag flag, const std::string &message)
+{
+  return IsLibraryAnnouncement(flag) && message == "OnUpdate";
+}
+
+// whether both items refer to the same library item
+bool IsSameLibraryItem(const CFileItem &item1, const CFileItem &item2)
+{
+  if (item1.HasVideoInfoTag() && item2.HasVideoInfoTag())
+  {
+    const CVideoInfoTag *tag1 = item1.GetVideoInfoTag();
+    const CVideoInfoTag *tag2 = item2.GetVideoInfoTag();
+    return tag1->m_iDbId > 0 && tag1->m_iDbId == tag2->m_iDbId && tag1->m_type == tag2->m_type;
+  }
+  if (item1.HasMusicInfoTag() && item2.HasMusicInfoTag() && !item1.HasVideoInfoTag() && !item2.HasVideoInfoTag())
+  {
+    const MUSIC_INFO::CMusicInfoTag *tag1 = item1.GetMusicInfoTag();
+    const MUSIC_INFO::CMusicInfoTag *tag2 = item2.GetMusicInfoTag();
+    return tag1->GetDatabaseId() > 0 && tag1->GetDatabaseId() == tag2->GetDatabaseId() && tag1->GetType() == tag2->GetType();
+  }
+  return false;
+}
+}
+
 CAnnouncementManager::CAnnouncementManager() : CThread("Announce")
 {
 }
@@ -46,6 +87,16 @@ void CAnnouncementManager::Deinitialize()
   StopThread();
   CSingleLock lock (m_announcersCritSection);
   m_announcers.clear();
+
+  Statistics statistics = GetStatistics();
+  CLog::Log(LOGDEBUG, LOGANNOUNCE, "CAnnouncementManager - {} announcements, {} coalesced, {} dropped",
+            statistics.announced, statistics.coalesced, statistics.dropped);
+}
+
+CAnnouncementManager::Statistics CAnnouncementManager::GetStatistics() const
+{
+  CSingleLock lock (m_queueCritSection);
+  return m_statistics;
 }
 
 void CAnnouncementManager::AddAnnouncer(IAnnouncer *listener)
@@ -98,16 +149,94 @@ void CAnnouncementManager::Announce(AnnouncementFlag flag, const char *sender, c
   announcement.message = message;
   announcement.data = data;
 
+  announcement.time = XbmcThreads::SystemClockMillis();
+
   if (item != nullptr)
     announcement.item = CFileItemPtr(new CFileItem(*item));
 
   {
     CSingleLock lock (m_queueCritSection);
-    m_announcementQueue.push_back(announcement);
+    std::list<CAnnounceData> &queue = IsLibraryAnnouncement(flag) ? m_libraryQueue : m_announcementQueue;
+    if (Coalesce(queue, announcement))
+    {
+      m_statistics.coalesced++;
+      return;
+    }
+
+    if (IsLibraryUpdate(flag, announcement.message))
+    {
+      if (m_queuedLibraryUpdates >= MAX_QUEUED_LIBRARY_UPDATES)
+      {
+        if (m_statistics.dropped++ == 0)
+          CLog::Log(LOGWARNING, "CAnnouncementManager - too many library updates queued, dropping them");
+        return;
+      }
+      m_queuedLibraryUpdates++;
+    }
+
+    queue.push_back(announcement);
   }
   m_queueEvent.Set();
 }
 
+bool CAnnouncementManager::Coalesce(std::list<CAnnounceData> &queue, const CAnnounceData &announcement)
+{
+  const bool libraryUpdate = IsLibraryUpdate(announcement.flag, announcement.message);
+  if (announcement.item != nullptr && !libraryUpdate)
+    return false;
+
+  int depth = 0;
+  for (auto it = queue.rbegin(); it != queue.rend() && depth < COALESCE_SEARCH_DEPTH; ++it, ++depth)
+  {
+    if (it->flag != announcement.flag || it->sender != announcement.sender)
+      continue;
+    if (it->message != announcement.message)
+      return false;
+
+    if (announcement.item == nullptr)
+    {
+      if (it->item == nullptr && it->data == announcement.data)
+        return true;
+    }
+    else if (it->item != nullptr && IsSameLibraryItem(*it->item, *announcement.item) &&
+             (it->data.isObject() || it->data.isNull()) && (announcement.data.isObject() || announcement.data.isNull()))
+    {
+      // e.g. the playcount and the "added" update of a newly scanned item
+      for (auto member = announcement.data.begin_map(); member != announcement.data.end_map(); ++member)
+        it->data[member->first] = member->second;
+      return true;
+    }
+  }
+  return false;
+}
+
+unsigned int CAnnouncementManager::TakeDueAnnouncements(std::vector<CAnnounceData> &announcements)
+{
+  for (auto &announcement : m_announcementQueue)
+    announcements.push_back(std::move(announcement));
+  m_announcementQueue.clear();
+
+  // library updates come in bursts (e.g. during scans), hold them back for a moment so that
+  // updates that follow can be merged into them. the announcements queued after them have to
+  // wait as well to keep the order
+  const unsigned int now = XbmcThreads::SystemClockMillis();
+  while (!m_libraryQueue.empty())
+  {
+    CAnnounceData &front = m_libraryQueue.front();
+    if (IsLibraryUpdate(front.flag, front.message))
+    {
+      unsigned int age = now - front.time;
+      if (age < COALESCE_WINDOW)
+        return COALESCE_WINDOW - age;
+      m_queuedLibraryUpdates--;
+    }
+
+    announcements.push_back(std::move(front));
+    m_libraryQueue.pop_front();
+  }
+  return 0;
+}
+
 void CAnnouncementManager::DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, const CVariant &data)
 {
   CLog::Log(LOGDEBUG, LOGANNOUNCE, "CAnnouncementManager - Announcement: {} from {}", message, sender);
@@ -272,22 +401,26 @@ void CAnnouncementManager::Process()
 {
   SetPriority(GetMinPriority());
 
+  std::vector<CAnnounceData> announcements;
   while (!m_bStop)
   {
-    CSingleLock lock (m_queueCritSection);
-    if (!m_announcementQueue.empty())
+    unsigned int wait;
     {
-      auto announcement = m_announcementQueue.front();
-      m_announcementQueue.pop_front();
-      {
-        CSingleExit ex(m_queueCritSection);
-        DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.item, announcement.data);
-      }
+      CSingleLock lock (m_queueCritSection);
+      wait = TakeDueAnnouncements(announcements);
+      m_statistics.announced += announcements.size();
     }
-    else
+
+    for (const auto &announcement : announcements)
+      DoAnnounce(announcement.flag, announcement.sender.c_str(), announcement.message.c_str(), announcement.item, announcement.data);
+
+    if (announcements.empty())
     {
-      CSingleExit ex(m_queueCritSection);
-      m_queueEvent.Wait();
+      if (wait > 0)
+        m_queueEvent.WaitMSec(wait);
+      else
+        m_queueEvent.Wait();
     }
+    announcements.clear();
   }
 }
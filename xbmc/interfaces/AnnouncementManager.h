@@ -16,6 +16,7 @@
 #include "utils/Variant.h"
 
 #include <list>
+#include <stdint.h>
 #include <vector>
 
 class CVariant;
@@ -41,6 +42,14 @@ namespace ANNOUNCEMENT
     void Announce(AnnouncementFlag flag, const char *sender, const char *message,
         const std::shared_ptr<const CFileItem>& item, const CVariant &data);
 
+    struct Statistics
+    {
+      uint64_t announced = 0; //!< announcements delivered to the announcers
+      uint64_t coalesced = 0; //!< announcements merged into a queued one
+      uint64_t dropped = 0;   //!< library updates dropped because too many were queued
+    };
+    Statistics GetStatistics() const;
+
   protected:
     void Process() override;
     void DoAnnounce(AnnouncementFlag flag, const char *sender, const char *message, CFileItemPtr item, const CVariant &data);
@@ -53,16 +62,36 @@ namespace ANNOUNCEMENT
       std::string message;
       CFileItemPtr item;
       CVariant data;
+      unsigned int time;
     };
-    std::list<CAnnounceData> m_announcementQueue;
+    std::list<CAnnounceData> m_announcementQueue; ///< announcements delivered right away
+    std::list<CAnnounceData> m_libraryQueue;      ///< library announcements, updates are held back for merging
+    unsigned int m_queuedLibraryUpdates = 0;      ///< number of library updates in m_libraryQueue
     CEvent m_queueEvent;
 
+    /*!
+     \brief Try to merge an announcement into one that is still queued.
+     Announcements without an item are merged into identical ones. Library updates of the same
+     library item are merged into one carrying the data of both. Merging never crosses an
+     announcement of the same kind with a different message (e.g. an OnRemove between two
+     OnUpdate), so that the resulting sequence of announcements still describes the same state.
+     \return true if the announcement was merged and doesn't need to be queued.
+     */
+    static bool Coalesce(std::list<CAnnounceData> &queue, const CAnnounceData &announcement);
+
+    /*!
+     \brief Move the announcements that are due from the queues into \p announcements.
+     \return time in ms until the next held back library update is due, 0 if there is none.
+     */
+    unsigned int TakeDueAnnouncements(std::vector<CAnnounceData> &announcements);
+
   private:
     CAnnouncementManager(const CAnnouncementManager&) = delete;
     CAnnouncementManager const& operator=(CAnnouncementManager const&) = delete;
 
     CCriticalSection m_announcersCritSection;
-    CCriticalSection m_queueCritSection;
+    mutable CCriticalSection m_queueCritSection;
     std::vector<IAnnouncer *> m_announcers;
+    Statistics m_statistics;
   };
 }
@@ -12,6 +12,16 @@
 #include <memory.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <algorithm>
+
+#if defined(TARGET_LINUX)
+#include <sys/epoll.h>
+#define HAS_EPOLL
+#endif
+#if !defined(TARGET_WINDOWS)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
@@ -49,6 +59,43 @@ static const bdaddr_t bt_bdaddr_local = {{0, 0, 0, 0xff, 0xff, 0xff}};
 using namespace JSONRPC;
 
 #define RECEIVEBUFFER 1024
+#define MAX_EPOLL_EVENTS 64
+#define MAX_REQUEST_WORKERS 4
+// queued output beyond which a client no longer receives announcements
+#define CONGESTED_OUTPUT (1024 * 1024)
+// queued output beyond which a client is disconnected
+#define MAX_QUEUED_OUTPUT (16 * 1024 * 1024)
+
+namespace
+{
+bool SetNonBlocking(SOCKET socket)
+{
+#ifdef TARGET_WINDOWS
+  u_long nonblocking = 1;
+  return ioctlsocket(socket, FIONBIO, &nonblocking) == 0;
+#else
+  return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+#endif
+}
+
+bool Interrupted()
+{
+#ifdef TARGET_WINDOWS
+  return WSAGetLastError() == WSAEINTR;
+#else
+  return errno == EINTR;
+#endif
+}
+
+bool WouldBlock()
+{
+#ifdef TARGET_WINDOWS
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+}
 
 CTCPServer *CTCPServer::ServerInstance = NULL;
 
@@ -87,11 +134,16 @@ bool CTCPServer::IsRunning()
   return ((CThread*)ServerInstance)->IsRunning();
 }
 
-CTCPServer::CTCPServer(int port, bool nonlocal) : CThread("TCPServer")
+CTCPServer::CTCPServer(int port, bool nonlocal) :
+  CThread("TCPServer"),
+  m_requestQueue(false, MAX_REQUEST_WORKERS, CJob::PRIORITY_NORMAL),
+  m_requestJobsDone(true, true)
 {
   m_port = port;
   m_nonlocal = nonlocal;
   m_sdpd = NULL;
+  m_epollfd = -1;
+  m_pendingRequestJobs = 0;
 }
 
 void CTCPServer::Process()
@@ -100,111 +152,276 @@ void CTCPServer::Process()
 
   while (!m_bStop)
   {
-    SOCKET          max_fd = 0;
-    fd_set          rfds;
-    struct timeval  to     = {1, 0};
-    FD_ZERO(&rfds);
+    std::vector<SOCKET> readable;
+    std::vector<SOCKET> writable;
 
-    for (auto& it : m_servers)
+    int res = WaitForEvents(readable, writable, 1000);
+    if (res < 0)
     {
-      FD_SET(it, &rfds);
-      if ((intptr_t)it > (intptr_t)max_fd)
-        max_fd = it;
+      CLog::Log(LOGERROR, "JSONRPC Server: Waiting for socket events failed");
+      Sleep(1000);
+      Initialize();
+      continue;
     }
 
-    for (unsigned int i = 0; i < m_connections.size(); i++)
+    for (auto& socket : writable)
+      WriteConnection(socket);
+
+    for (auto& socket : readable)
     {
-      FD_SET(m_connections[i]->m_socket, &rfds);
-      if ((intptr_t)m_connections[i]->m_socket > (intptr_t)max_fd)
-        max_fd = m_connections[i]->m_socket;
+      if (std::find(m_servers.begin(), m_servers.end(), socket) != m_servers.end())
+        AcceptConnection(socket);
+      else
+        ReadConnection(socket);
     }
+  }
 
-    int res = select((intptr_t)max_fd+1, &rfds, NULL, NULL, &to);
+  Deinitialize();
+}
+
+int CTCPServer::WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable, int timeout)
+{
+#if defined(HAS_EPOLL)
+  if (m_epollfd >= 0)
+  {
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int res = epoll_wait(m_epollfd, events, MAX_EPOLL_EVENTS, timeout);
     if (res < 0)
+      return errno == EINTR ? 0 : -1;
+
+    for (int i = 0; i < res; i++)
+    {
+      if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+        readable.push_back(events[i].data.fd);
+      if (events[i].events & EPOLLOUT)
+        writable.push_back(events[i].data.fd);
+    }
+    return res;
+  }
+#endif
+
+  SOCKET          max_fd = 0;
+  fd_set          rfds;
+  fd_set          wfds;
+  struct timeval  to     = {timeout / 1000, (timeout % 1000) * 1000};
+  FD_ZERO(&rfds);
+  FD_ZERO(&wfds);
+
+  for (auto& it : m_servers)
+  {
+    FD_SET(it, &rfds);
+    if ((intptr_t)it > (intptr_t)max_fd)
+      max_fd = it;
+  }
+
+  for (auto& it : m_connections)
+  {
+    FD_SET(it.first, &rfds);
+    if (it.second->HasPendingOutput())
+      FD_SET(it.first, &wfds);
+    if ((intptr_t)it.first > (intptr_t)max_fd)
+      max_fd = it.first;
+  }
+
+  int res = select((intptr_t)max_fd+1, &rfds, &wfds, NULL, &to);
+  if (res <= 0)
+    return res;
+
+  for (auto& it : m_servers)
+  {
+    if (FD_ISSET(it, &rfds))
+      readable.push_back(it);
+  }
+
+  for (auto& it : m_connections)
+  {
+    if (FD_ISSET(it.first, &rfds))
+      readable.push_back(it.first);
+    if (FD_ISSET(it.first, &wfds))
+      writable.push_back(it.first);
+  }
+  return res;
+}
+
+void CTCPServer::AddSocket(SOCKET socket, bool server)
+{
+#if defined(HAS_EPOLL)
+  if (m_epollfd >= 0)
+  {
+    // connections are edge triggered so that writability is only reported once the socket
+    // drained, which means reads have to be done until they would block
+    struct epoll_event event = {};
+    event.events = server ? EPOLLIN : (EPOLLIN | EPOLLOUT | EPOLLET);
+    event.data.fd = socket;
+    if (epoll_ctl(m_epollfd, EPOLL_CTL_ADD, socket, &event) < 0)
+      CLog::Log(LOGERROR, "JSONRPC Server: Failed to watch socket %d: %d", (int)socket, errno);
+  }
+#endif
+}
+
+void CTCPServer::AcceptConnection(SOCKET server)
+{
+  CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
+  std::shared_ptr<CTCPClient> newconnection(new CTCPClient());
+  newconnection->m_socket =
+      accept(server, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
+
+  if (newconnection->m_socket == INVALID_SOCKET)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
+    if (EBADF == errno)
     {
-      CLog::Log(LOGERROR, "JSONRPC Server: Select failed");
       Sleep(1000);
       Initialize();
     }
-    else if (res > 0)
+    return;
+  }
+
+#if !defined(TARGET_WINDOWS)
+  if (m_epollfd < 0 && newconnection->m_socket >= FD_SETSIZE)
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Too many connections, dropping new connection");
+    closesocket(newconnection->m_socket);
+    return;
+  }
+#endif
+
+  if (!SetNonBlocking(newconnection->m_socket))
+  {
+    CLog::Log(LOGERROR, "JSONRPC Server: Failed to make new connection non-blocking");
+    closesocket(newconnection->m_socket);
+    return;
+  }
+
+  CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
+  {
+    CSingleLock lock(m_connectionsSection);
+    m_connections[newconnection->m_socket] = newconnection;
+  }
+  AddSocket(newconnection->m_socket, false);
+}
+
+void CTCPServer::ReadConnection(SOCKET socket)
+{
+  auto it = m_connections.find(socket);
+  if (it == m_connections.end())
+    return;
+
+  bool close = false;
+  while (!close)
+  {
+    char buffer[RECEIVEBUFFER] = {};
+    int  nread = 0;
+    nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
+    // with edge triggered events nothing is reported again for data that is left unread
+    if (nread < 0 && Interrupted())
+      continue;
+    if (nread < 0 && WouldBlock())
+      break;
+
+    if (nread > 0)
     {
-      for (int i = m_connections.size() - 1; i >= 0; i--)
+      std::string response;
+      if (it->second->IsNew())
       {
-        int socket = m_connections[i]->m_socket;
-        if (FD_ISSET(socket, &rfds))
-        {
-          char buffer[RECEIVEBUFFER] = {};
-          int  nread = 0;
-          nread = recv(socket, (char*)&buffer, RECEIVEBUFFER, 0);
-          bool close = false;
-          if (nread > 0)
-          {
-            std::string response;
-            if (m_connections[i]->IsNew())
-            {
-              CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
-
-              if (!response.empty())
-                m_connections[i]->Send(response.c_str(), response.size());
-
-              if (websocket != NULL)
-              {
-                // Replace the CTCPClient with a CWebSocketClient
-                CWebSocketClient *websocketClient = new CWebSocketClient(websocket, *(m_connections[i]));
-                delete m_connections[i];
-                m_connections.erase(m_connections.begin() + i);
-                m_connections.insert(m_connections.begin() + i, websocketClient);
-              }
-            }
-
-            if (response.size() <= 0)
-              m_connections[i]->PushBuffer(this, buffer, nread);
-
-            close = m_connections[i]->Closing();
-          }
-          else
-            close = true;
+        CWebSocket *websocket = CWebSocketManager::Handle(buffer, nread, response);
 
-          if (close)
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
-            m_connections[i]->Disconnect();
-            delete m_connections[i];
-            m_connections.erase(m_connections.begin() + i);
-          }
-        }
-      }
+        if (!response.empty())
+          it->second->Send(response.c_str(), response.size());
 
-      for (auto& it : m_servers)
-      {
-        if (FD_ISSET(it, &rfds))
+        if (websocket != NULL)
         {
-          CLog::Log(LOGDEBUG, "JSONRPC Server: New connection detected");
-          CTCPClient *newconnection = new CTCPClient();
-          newconnection->m_socket =
-              accept(it, (sockaddr*)&newconnection->m_cliaddr, &newconnection->m_addrlen);
-
-          if (newconnection->m_socket == INVALID_SOCKET)
-          {
-            CLog::Log(LOGERROR, "JSONRPC Server: Accept of new connection failed: %d", errno);
-            if (EBADF == errno)
-            {
-              Sleep(1000);
-              Initialize();
-              break;
-            }
-          }
-          else
-          {
-            CLog::Log(LOGINFO, "JSONRPC Server: New connection added");
-            m_connections.push_back(newconnection);
-          }
+          // Replace the CTCPClient with a CWebSocketClient
+          CSingleLock lock(m_connectionsSection);
+          it->second.reset(new CWebSocketClient(websocket, *(it->second)));
         }
       }
+
+      if (response.size() <= 0)
+        it->second->PushBuffer(this, buffer, nread);
+
+      close = it->second->Closing();
     }
+    else
+      close = true;
   }
 
-  Deinitialize();
+  if (close)
+  {
+    CLog::Log(LOGINFO, "JSONRPC Server: Disconnection detected");
+    RemoveConnection(socket);
+  }
+  else
+    ScheduleRequests(it->second);
+}
+
+void CTCPServer::WriteConnection(SOCKET socket)
+{
+  auto it = m_connections.find(socket);
+  if (it != m_connections.end())
+    it->second->Flush();
+}
+
+void CTCPServer::RemoveConnection(SOCKET socket)
+{
+  std::shared_ptr<CTCPClient> client;
+  {
+    CSingleLock lock(m_connectionsSection);
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end())
+      return;
+    client = it->second;
+    m_connections.erase(it);
+  }
+
+  // closing the socket also removes it from the epoll set. a request of the client that is
+  // still being processed keeps the client alive, its response is discarded
+  client->Disconnect();
+}
+
+class CTCPServer::CRequestJob : public CJob
+{
+public:
+  CRequestJob(CTCPServer *server, const std::shared_ptr<CTCPClient> &client) :
+    m_server(server),
+    m_client(client)
+  {
+    CSingleLock lock(m_server->m_pendingRequestJobsSection);
+    if (m_server->m_pendingRequestJobs++ == 0)
+      m_server->m_requestJobsDone.Reset();
+  }
+  ~CRequestJob() override
+  {
+    CSingleLock lock(m_server->m_pendingRequestJobsSection);
+    if (--m_server->m_pendingRequestJobs == 0)
+      m_server->m_requestJobsDone.Set();
+  }
+
+  bool DoWork() override
+  {
+    m_server->ProcessRequests(m_client);
+    return true;
+  }
+
+private:
+  CTCPServer *m_server;
+  std::shared_ptr<CTCPClient> m_client;
+};
+
+void CTCPServer::ScheduleRequests(const std::shared_ptr<CTCPClient> &client)
+{
+  if (client->StartProcessing())
+    m_requestQueue.AddJob(new CRequestJob(this, client));
+}
+
+void CTCPServer::ProcessRequests(const std::shared_ptr<CTCPClient> &client)
+{
+  std::string request;
+  while (client->NextRequest(request))
+  {
+    std::string response = CJSONRPC::MethodCall(request, this, client.get());
+    client->Send(response.c_str(), response.size());
+  }
 }
 
 bool CTCPServer::PrepareDownload(const char *path, CVariant &details, std::string &protocol)
@@ -226,15 +443,36 @@ void CTCPServer::Announce(ANNOUNCEMENT::AnnouncementFlag flag, const char *sende
 {
   std::string str = IJSONRPCAnnouncer::AnnouncementToJSONRPC(flag, sender, message, data, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_jsonOutputCompact);
 
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  std::vector<std::shared_ptr<CTCPClient> > connections;
+  {
+    CSingleLock lock(m_connectionsSection);
+    connections.reserve(m_connections.size());
+    for (const auto& it : m_connections)
+      connections.push_back(it.second);
+  }
+
+  for (auto& connection : connections)
   {
     {
-      CSingleLock lock (m_connections[i]->m_critSection);
-      if ((m_connections[i]->GetAnnouncementFlags() & flag) == 0)
+      CSingleLock lock (connection->m_critSection);
+      if ((connection->GetAnnouncementFlags() & flag) == 0)
         continue;
+
+      // don't let announcements pile up for clients that don't read them
+      if (connection->IsCongested())
+      {
+        if (connection->m_droppedAnnouncements++ == 0)
+          CLog::Log(LOGWARNING, "JSONRPC Server: Client is not reading its data, dropping announcements");
+        continue;
+      }
+      if (connection->m_droppedAnnouncements > 0)
+      {
+        CLog::Log(LOGINFO, "JSONRPC Server: Client caught up, %u announcements were dropped", connection->m_droppedAnnouncements);
+        connection->m_droppedAnnouncements = 0;
+      }
     }
 
-    m_connections[i]->Send(str.c_str(), str.size());
+    connection->Send(str.c_str(), str.size());
   }
 }
 
@@ -242,6 +480,12 @@ bool CTCPServer::Initialize()
 {
   Deinitialize();
 
+#if defined(HAS_EPOLL)
+  m_epollfd = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epollfd < 0)
+    CLog::Log(LOGWARNING, "JSONRPC Server: Failed to create epoll instance, falling back to select");
+#endif
+
   bool started = false;
 
   started |= InitializeBlue();
@@ -249,6 +493,9 @@ bool CTCPServer::Initialize()
 
   if (started)
   {
+    for (auto& it : m_servers)
+      AddSocket(it, true);
+
     CServiceBroker::GetAnnouncementManager()->AddAnnouncer(this);
     CLog::Log(LOGINFO, "JSONRPC Server: Successfully initialized");
     return true;
@@ -450,8 +697,6 @@ bool CTCPServer::InitializeBlue()
 
 bool CTCPServer::InitializeTCP()
 {
-  Deinitialize();
-
   std::vector<SOCKET> sockets = CreateTCPServerSocket(m_port, !m_nonlocal, 10, "JSONRPC");
   if (sockets.empty())
     return false;
@@ -462,13 +707,17 @@ bool CTCPServer::InitializeTCP()
 
 void CTCPServer::Deinitialize()
 {
-  for (unsigned int i = 0; i < m_connections.size(); i++)
+  // wait for requests that are being processed, they still reference us as their transport
+  m_requestQueue.CancelJobs();
+  m_requestJobsDone.Wait();
+
   {
-    m_connections[i]->Disconnect();
-    delete m_connections[i];
-  }
+    CSingleLock lock(m_connectionsSection);
+    for (auto& it : m_connections)
+      it.second->Disconnect();
 
-  m_connections.clear();
+    m_connections.clear();
+  }
 
   for (unsigned int i = 0; i < m_servers.size(); i++)
     closesocket(m_servers[i]);
@@ -481,12 +730,20 @@ void CTCPServer::Deinitialize()
   m_sdpd = NULL;
 #endif
 
+#if defined(HAS_EPOLL)
+  if (m_epollfd >= 0)
+    close(m_epollfd);
+#endif
+  m_epollfd = -1;
+
   CServiceBroker::GetAnnouncementManager()->RemoveAnnouncer(this);
 }
 
 CTCPServer::CTCPClient::CTCPClient()
 {
   m_new = true;
+  m_processing = false;
+  m_droppedAnnouncements = 0;
   m_announcementflags = ANNOUNCEMENT::ANNOUNCE_ALL;
   m_socket = INVALID_SOCKET;
   m_beginBrackets = 0;
@@ -526,12 +783,77 @@ bool CTCPServer::CTCPClient::SetAnnouncementFlags(int flags)
 
 void CTCPServer::CTCPClient::Send(const char *data, unsigned int size)
 {
-  unsigned int sent = 0;
-  do
+  CSingleLock lock (m_critSection);
+  if (m_socket == INVALID_SOCKET)
+    return;
+
+  if (m_output.size() + size > MAX_QUEUED_OUTPUT)
   {
-    CSingleLock lock (m_critSection);
-    sent += send(m_socket, data + sent, size - sent, 0);
-  } while (sent < size);
+    CLog::Log(LOGERROR, "JSONRPC Server: Client is not reading its data, disconnecting");
+    shutdown(m_socket, SHUT_RDWR);
+    return;
+  }
+
+  m_output.append(data, size);
+  Flush();
+}
+
+void CTCPServer::CTCPClient::Flush()
+{
+  CSingleLock lock (m_critSection);
+  size_t sent = 0;
+  while (sent < m_output.size() && m_socket != INVALID_SOCKET)
+  {
+    int res = send(m_socket, m_output.c_str() + sent, m_output.size() - sent, 0);
+    if (res < 0 && Interrupted())
+      continue;
+    if (res < 0)
+    {
+      // the rest is sent once the socket is writable again. on errors the socket will also be
+      // reported as readable, the following failing read then takes care of the disconnection
+      if (!WouldBlock())
+        m_output.clear();
+      break;
+    }
+    sent += res;
+  }
+  m_output.erase(0, sent);
+}
+
+bool CTCPServer::CTCPClient::HasPendingOutput()
+{
+  CSingleLock lock (m_critSection);
+  return !m_output.empty();
+}
+
+bool CTCPServer::CTCPClient::IsCongested()
+{
+  CSingleLock lock (m_critSection);
+  return m_output.size() > CONGESTED_OUTPUT;
+}
+
+bool CTCPServer::CTCPClient::StartProcessing()
+{
+  CSingleLock lock (m_critSection);
+  if (m_processing || m_requests.empty())
+    return false;
+
+  m_processing = true;
+  return true;
+}
+
+bool CTCPServer::CTCPClient::NextRequest(std::string &request)
+{
+  CSingleLock lock (m_critSection);
+  if (m_requests.empty())
+  {
+    m_processing = false;
+    return false;
+  }
+
+  request = std::move(m_requests.front());
+  m_requests.pop_front();
+  return true;
 }
 
 void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
@@ -597,8 +919,11 @@ void CTCPServer::CTCPClient::PushBuffer(CTCPServer *host, const char *buffer, in
       }
       if (m_beginBrackets > 0 && m_endBrackets > 0 && m_beginBrackets == m_endBrackets)
       {
-        std::string line = CJSONRPC::MethodCall(m_buffer, host, this);
-        Send(line.c_str(), line.size());
+        // the request is executed by the worker pool, see CTCPServer::ScheduleRequests
+        {
+          CSingleLock lock (m_critSection);
+          m_requests.push_back(std::move(m_buffer));
+        }
         m_beginChar = m_beginBrackets = m_endBrackets = 0;
         m_buffer.clear();
       }
@@ -629,6 +954,10 @@ void CTCPServer::CTCPClient::Copy(const CTCPClient& client)
   m_beginChar         = client.m_beginChar;
   m_endChar           = client.m_endChar;
   m_buffer            = client.m_buffer;
+  m_output            = client.m_output;
+  m_requests          = client.m_requests;
+  m_processing        = false;
+  m_droppedAnnouncements = client.m_droppedAnnouncements;
 }
 
 CTCPServer::CWebSocketClient::CWebSocketClient(CWebSocket *websocket)
@@ -662,19 +991,30 @@ CTCPServer::CWebSocketClient& CTCPServer::CWebSocketClient::operator=(const CWeb
   return *this;
 }
 
+bool CTCPServer::CWebSocketClient::Closing() const
+{
+  CSingleLock lock (m_critSection);
+  return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed;
+}
+
 void CTCPServer::CWebSocketClient::Send(const char *data, unsigned int size)
 {
+  // responses and announcements are sent from different threads, so the websocket state and
+  // the frames of a message have to be handled under the client's lock
+  CSingleLock lock (m_critSection);
   const CWebSocketMessage *msg = m_websocket->Send(WebSocketTextFrame, data, size);
-  if (msg == NULL || !msg->IsComplete())
+  if (msg == NULL)
     return;
 
-  std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
-  for (unsigned int index = 0; index < frames.size(); index++)
-    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+  if (msg->IsComplete())
+    SendFrames(msg);
+
+  delete msg;
 }
 
 void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buffer, int length)
 {
+  CSingleLock lock (m_critSection);
   bool send;
   const CWebSocketMessage *msg = NULL;
   size_t len = length;
@@ -682,14 +1022,11 @@ void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buff
   {
     if ((msg = m_websocket->Handle(buffer, len, send)) != NULL && msg->IsComplete())
     {
-      std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
       if (send)
-      {
-        for (unsigned int index = 0; index < frames.size(); index++)
-          Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
-      }
+        SendFrames(msg);
       else
       {
+        std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
         for (unsigned int index = 0; index < frames.size(); index++)
           CTCPClient::PushBuffer(host, frames.at(index)->GetApplicationData(), (int)frames.at(index)->GetLength());
       }
@@ -705,13 +1042,17 @@ void CTCPServer::CWebSocketClient::PushBuffer(CTCPServer *host, const char *buff
 
 void CTCPServer::CWebSocketClient::Disconnect()
 {
+  CSingleLock lock (m_critSection);
   if (m_socket > 0)
   {
     if (m_websocket->GetState() != WebSocketStateClosed && m_websocket->GetState() != WebSocketStateNotConnected)
     {
       const CWebSocketFrame *closeFrame = m_websocket->Close();
       if (closeFrame)
-        Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
+      {
+        CTCPClient::Send(closeFrame->GetFrameData(), (unsigned int)closeFrame->GetFrameLength());
+        delete closeFrame;
+      }
     }
 
     if (m_websocket->GetState() == WebSocketStateClosed)
@@ -719,3 +1060,11 @@ void CTCPServer::CWebSocketClient::Disconnect()
   }
 }
 
+void CTCPServer::CWebSocketClient::SendFrames(const CWebSocketMessage *msg)
+{
+  // the frames are already encoded, queue them as they are
+  std::vector<const CWebSocketFrame *> frames = msg->GetFrames();
+  for (unsigned int index = 0; index < frames.size(); index++)
+    CTCPClient::Send(frames.at(index)->GetFrameData(), (unsigned int)frames.at(index)->GetFrameLength());
+}
+
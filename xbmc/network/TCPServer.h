@@ -12,9 +12,15 @@
 #include "interfaces/json-rpc/IJSONRPCAnnouncer.h"
 #include "interfaces/json-rpc/ITransportLayer.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/Thread.h"
+#include "utils/JobManager.h"
 #include "websocket/WebSocket.h"
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include <sys/socket.h>
@@ -46,6 +52,32 @@ namespace JSONRPC
     bool InitializeTCP();
     void Deinitialize();
 
+    class CTCPClient;
+    class CRequestJob;
+
+    /*!
+     \brief Wait for socket activity on the servers and connections.
+     Uses epoll where available and falls back to select() otherwise.
+     \param readable sockets that can be read from (or have been closed).
+     \param writable sockets that can take more queued output.
+     \param timeout maximum time to wait in milliseconds.
+     \return number of sockets with activity, or -1 on error.
+     */
+    int WaitForEvents(std::vector<SOCKET> &readable, std::vector<SOCKET> &writable, int timeout);
+    void AddSocket(SOCKET socket, bool server);
+    void AcceptConnection(SOCKET server);
+    void ReadConnection(SOCKET socket);
+    void WriteConnection(SOCKET socket);
+    void RemoveConnection(SOCKET socket);
+
+    /*!
+     \brief Hand the queued requests of a client to the worker pool.
+     Requests of a single client are executed in order, one at a time, so responses are sent in
+     the order the requests were received.
+     */
+    void ScheduleRequests(const std::shared_ptr<CTCPClient> &client);
+    void ProcessRequests(const std::shared_ptr<CTCPClient> &client);
+
     class CTCPClient : public IClient
     {
     public:
@@ -60,6 +92,11 @@ namespace JSONRPC
       int GetAnnouncementFlags() override;
       bool SetAnnouncementFlags(int flags) override;
 
+      /*!
+       \brief Send data to the client.
+       Whatever can't be written to the socket right away is queued and written once the socket
+       becomes writable again.
+       */
       virtual void Send(const char *data, unsigned int size);
       virtual void PushBuffer(CTCPServer *host, const char *buffer, int length);
       virtual void Disconnect();
@@ -67,10 +104,33 @@ namespace JSONRPC
       virtual bool IsNew() const { return m_new; }
       virtual bool Closing() const { return false; }
 
+      /*!
+       \brief Write as much of the queued output as the socket takes.
+       */
+      void Flush();
+      bool HasPendingOutput();
+      /*!
+       \brief Whether the client doesn't keep up with reading its output.
+       Announcements to congested clients are dropped instead of being queued.
+       */
+      bool IsCongested();
+
+      /*!
+       \brief Mark the client as being processed if it has queued requests.
+       \return true if the caller is responsible for processing the queued requests.
+       */
+      bool StartProcessing();
+      /*!
+       \brief Take the next queued request, or finish processing if there are none left.
+       \return true if a request was taken from the queue.
+       */
+      bool NextRequest(std::string &request);
+
       SOCKET m_socket;
       sockaddr_storage m_cliaddr;
       socklen_t m_addrlen;
-      CCriticalSection m_critSection;
+      mutable CCriticalSection m_critSection;
+      unsigned int m_droppedAnnouncements;
 
     protected:
       void Copy(const CTCPClient& client);
@@ -80,6 +140,9 @@ namespace JSONRPC
       int m_beginBrackets, m_endBrackets;
       char m_beginChar, m_endChar;
       std::string m_buffer;
+      std::string m_output;
+      std::deque<std::string> m_requests;
+      bool m_processing;
     };
 
     class CWebSocketClient : public CTCPClient
@@ -96,14 +159,22 @@ namespace JSONRPC
       void Disconnect() override;
 
       bool IsNew() const override { return m_websocket == NULL; }
-      bool Closing() const override { return m_websocket != NULL && m_websocket->GetState() == WebSocketStateClosed; }
+      bool Closing() const override;
 
     private:
+      void SendFrames(const CWebSocketMessage *msg);
+
       CWebSocket *m_websocket;
     };
 
-    std::vector<CTCPClient*> m_connections;
+    std::map<SOCKET, std::shared_ptr<CTCPClient> > m_connections;
+    CCriticalSection m_connectionsSection;
     std::vector<SOCKET> m_servers;
+    int m_epollfd;
+    CJobQueue m_requestQueue;
+    int m_pendingRequestJobs;
+    CCriticalSection m_pendingRequestJobsSection;
+    CEvent m_requestJobsDone; ///< set while no request job exists
     int m_port;
     bool m_nonlocal;
     void* m_sdpd;
@@ -14,10 +14,14 @@
 #include <utility>
 
 #if defined(TARGET_POSIX)
+#include <fcntl.h>
 #include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 #include "filesystem/File.h"
+#include "filesystem/SpecialProtocol.h"
 #include "network/httprequesthandler/HTTPRequestHandlerUtils.h"
 #include "network/httprequesthandler/IHTTPRequestHandler.h"
 #include "settings/AdvancedSettings.h"
@@ -27,6 +31,7 @@
 #include "threads/SingleLock.h"
 #include "Util.h"
 #include "utils/FileUtils.h"
+#include "utils/JobManager.h"
 #include "utils/log.h"
 #include "utils/Mime.h"
 #include "utils/StringUtils.h"
@@ -43,8 +48,26 @@
 
 #define HEADER_NEWLINE        "\r\n"
 
+// amount of file data read ahead at once in thread pool mode
+#define READ_AHEAD_SIZE (256 * 1024)
+
+struct HttpFileReadAhead
+{
+  CCriticalSection section;
+  struct MHD_Connection *connection;
+  std::vector<char> data; ///< data ready to be sent, starting at dataPosition
+  uint64_t dataPosition;
+  std::vector<char> next; ///< data read ahead, starting at nextPosition
+  uint64_t nextPosition;
+  bool reading;
+  bool suspended;
+  bool failed;
+  bool closed;
+};
+
 typedef struct {
   std::shared_ptr<XFILE::CFile> file;
+  std::shared_ptr<HttpFileReadAhead> readAhead;
   CHttpRanges ranges;
   size_t rangeCountTotal;
   std::string boundary;
@@ -756,6 +779,29 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
     context->boundaryWritten = false;
     context->writePosition = 0;
 
+#if (MHD_VERSION >= 0x00095207)
+    // suspending connections requires MHD_USE_SUSPEND_RESUME, which is only set in thread pool mode
+    if (m_threadPoolSize > 0)
+    {
+      context->readAhead = std::make_shared<HttpFileReadAhead>();
+      context->readAhead->connection = request.connection;
+      context->readAhead->dataPosition = 0;
+      context->readAhead->nextPosition = 0;
+      context->readAhead->reading = false;
+      context->readAhead->suspended = false;
+      context->readAhead->failed = false;
+      context->readAhead->closed = false;
+
+      // remember it so that Stop() can resume the connection, forgetting finished downloads
+      CSingleLock lock(m_critSection);
+      context->readAhead->failed = m_stopping;
+      m_readAheads.erase(std::remove_if(m_readAheads.begin(), m_readAheads.end(),
+                                        [](const std::weak_ptr<HttpFileReadAhead>& readAhead) { return readAhead.expired(); }),
+                         m_readAheads.end());
+      m_readAheads.push_back(context->readAhead);
+    }
+#endif
+
     if (handler->IsRequestRanged())
     {
       if (!request.ranges.IsEmpty())
@@ -811,21 +857,34 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
       totalLength += context->boundaryEnd.size();
     }
 
-    // set the initial write position
-    context->ranges.GetFirstPosition(context->writePosition);
+    // serve a single range of a local file straight from its file descriptor which allows
+    // libmicrohttpd to use sendfile() instead of copying the data through ContentReaderCallback
+    response = nullptr;
+    if (context->rangeCountTotal == 1)
+    {
+      uint64_t start = 0;
+      context->ranges.GetFirstPosition(start);
+      response = CreateFileDescriptorResponse(filePath, start, totalLength);
+    }
 
-    // create the response object
-    response = MHD_create_response_from_callback(totalLength, 2048,
-                                                  &CWebServer::ContentReaderCallback,
-                                                  context.get(),
-                                                  &CWebServer::ContentReaderFreeCallback);
     if (response == nullptr)
     {
-      CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
-      return MHD_NO;
-    }
+      // set the initial write position
+      context->ranges.GetFirstPosition(context->writePosition);
+
+      // create the response object
+      response = MHD_create_response_from_callback(totalLength, 2048,
+                                                    &CWebServer::ContentReaderCallback,
+                                                    context.get(),
+                                                    &CWebServer::ContentReaderFreeCallback);
+      if (response == nullptr)
+      {
+        CLog::Log(LOGERROR, "CWebServer[%hu]: failed to create a HTTP response for %s to be filled from %s", m_port, request.pathUrl.c_str(), filePath.c_str());
+        return MHD_NO;
+      }
 
-    context.release(); // ownership was passed to mhd
+      context.release(); // ownership was passed to mhd
+    }
 
     // add Content-Range header
     if (ranged)
@@ -850,6 +909,40 @@ int CWebServer::CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHan
   return MHD_YES;
 }
 
+struct MHD_Response* CWebServer::CreateFileDescriptorResponse(const std::string &filePath, uint64_t offset, uint64_t length) const
+{
+#if defined(TARGET_POSIX)
+  // only files on local filesystems can be served from a file descriptor
+  std::string localPath = CSpecialProtocol::TranslatePath(filePath);
+  if (localPath.empty() || localPath[0] != '/' || !URIUtils::IsHD(localPath) || URIUtils::IsInArchive(localPath))
+    return nullptr;
+
+  int fd = open(localPath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<uint64_t>(st.st_size) < offset + length)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  // libmicrohttpd takes ownership of the file descriptor
+  struct MHD_Response *response = MHD_create_response_from_fd_at_offset64(length, fd, offset);
+  if (response == nullptr)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  CLog::Log(LOGDEBUG, LOGWEBSERVER, "CWebServer[%hu] [OUT] serving %" PRIu64 " bytes at %" PRIu64 " of %s from its file descriptor", m_port, length, offset, localPath.c_str());
+  return response;
+#else
+  return nullptr;
+#endif
+}
+
 int CWebServer::CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const
 {
   size_t payloadSize = 0;
@@ -998,14 +1091,29 @@ ssize_t CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, si
   // adjust the maximum number of read bytes
   maximum = std::min(maximum, end - context->writePosition + 1);
 
-  // seek to the position if necessary
-  if (context->file->GetPosition() < 0 || context->writePosition != static_cast<uint64_t>(context->file->GetPosition()))
-    context->file->Seek(context->writePosition);
+  ssize_t res;
+#if (MHD_VERSION >= 0x00095207)
+  if (context->readAhead)
+  {
+    res = ReadAheadContent(context, buf, static_cast<size_t>(maximum));
+    if (res < 0)
+      return -1;
+    // the connection has been suspended until data is available, send what we have so far
+    if (res == 0)
+      return written;
+  }
+  else
+#endif
+  {
+    // seek to the position if necessary
+    if (context->file->GetPosition() < 0 || context->writePosition != static_cast<uint64_t>(context->file->GetPosition()))
+      context->file->Seek(context->writePosition);
 
-  // read data from the file
-  ssize_t res = context->file->Read(buf, static_cast<size_t>(maximum));
-  if (res <= 0)
-    return -1;
+    // read data from the file
+    res = context->file->Read(buf, static_cast<size_t>(maximum));
+    if (res <= 0)
+      return -1;
+  }
 
   // add the number of read bytes to the number of written bytes
   written += res;
@@ -1026,9 +1134,93 @@ ssize_t CWebServer::ContentReaderCallback(void *cls, uint64_t pos, char *buf, si
   return written;
 }
 
+#if (MHD_VERSION >= 0x00095207)
+ssize_t CWebServer::ReadAheadContent(void *cls, char *buf, size_t max)
+{
+  HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  std::shared_ptr<HttpFileReadAhead> readAhead = context->readAhead;
+
+  CHttpRange range;
+  if (!context->ranges.GetFirst(range))
+    return -1;
+
+  CSingleLock lock(readAhead->section);
+  if (readAhead->failed)
+    return -1;
+
+  // move on to the data read ahead once we're through the current data
+  const uint64_t position = context->writePosition;
+  if ((position < readAhead->dataPosition || position >= readAhead->dataPosition + readAhead->data.size()) &&
+      !readAhead->reading && position == readAhead->nextPosition && !readAhead->next.empty())
+  {
+    readAhead->data.swap(readAhead->next);
+    readAhead->dataPosition = readAhead->nextPosition;
+    readAhead->next.clear();
+  }
+
+  size_t copied = 0;
+  uint64_t readPosition = position;
+  if (position >= readAhead->dataPosition && position < readAhead->dataPosition + readAhead->data.size())
+  {
+    size_t offset = static_cast<size_t>(position - readAhead->dataPosition);
+    copied = std::min(max, readAhead->data.size() - offset);
+    memcpy(buf, readAhead->data.data() + offset, copied);
+    readPosition = readAhead->dataPosition + readAhead->data.size();
+  }
+
+  // start reading the following data unless it's already there or on its way
+  if (!readAhead->reading && readPosition <= range.GetLastPosition() &&
+      (readAhead->next.empty() || readAhead->nextPosition != readPosition))
+  {
+    readAhead->reading = true;
+    readAhead->next.clear();
+    readAhead->nextPosition = readPosition;
+
+    size_t size = static_cast<size_t>(std::min<uint64_t>(READ_AHEAD_SIZE, range.GetLastPosition() - readPosition + 1));
+    std::shared_ptr<XFILE::CFile> file = context->file;
+    CJobManager::GetInstance().Submit([readAhead, file, readPosition, size]() {
+      std::vector<char> data(size);
+      ssize_t read = -1;
+      if (file->Seek(readPosition) == static_cast<int64_t>(readPosition))
+        read = file->Read(data.data(), size);
+
+      CSingleLock lock(readAhead->section);
+      readAhead->reading = false;
+      if (read > 0)
+      {
+        data.resize(read);
+        readAhead->next.swap(data);
+      }
+      else
+        readAhead->failed = true;
+
+      if (readAhead->suspended && !readAhead->closed)
+      {
+        readAhead->suspended = false;
+        MHD_resume_connection(readAhead->connection);
+      }
+    }, CJob::PRIORITY_NORMAL);
+  }
+
+  if (copied > 0)
+    return copied;
+
+  // nothing to send until the read completes
+  readAhead->suspended = true;
+  MHD_suspend_connection(readAhead->connection);
+  return 0;
+}
+#endif
+
 void CWebServer::ContentReaderFreeCallback(void *cls)
 {
   HttpFileDownloadContext *context = (HttpFileDownloadContext *)cls;
+  if (context != nullptr && context->readAhead)
+  {
+    // make sure a pending read doesn't touch the connection anymore
+    CSingleLock lock(context->readAhead->section);
+    context->readAhead->closed = true;
+  }
   delete context;
 
   CLog::Log(LOGDEBUG, LOGWEBSERVER, "CWebServer [OUT] done");
@@ -1106,18 +1298,39 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
 
   MHD_set_panic_func(&panicHandlerForMHD, nullptr);
 
+  // one thread per connection
+  // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
+  // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
+  unsigned int threadingFlags = MHD_USE_THREAD_PER_CONNECTION
+#if (MHD_VERSION >= 0x00095207)
+                                | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
+#endif
+                                ;
+  struct MHD_OptionItem threadingOptions[] = {
+    { MHD_OPTION_END, 0, nullptr },
+    { MHD_OPTION_END, 0, nullptr }
+  };
+
+#if (MHD_VERSION >= 0x00095207)
+  // alternatively serve all connections from a pool of threads, file reads are then done in the
+  // background with the connection being suspended meanwhile
+  if (m_threadPoolSize > 0)
+  {
+    threadingFlags = MHD_USE_INTERNAL_POLLING_THREAD | MHD_USE_SUSPEND_RESUME;
+    if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES)
+      threadingFlags |= MHD_USE_EPOLL;
+
+    threadingOptions[0].option = MHD_OPTION_THREAD_POOL_SIZE;
+    threadingOptions[0].value = m_threadPoolSize;
+  }
+#endif
+
   if (CServiceBroker::GetSettingsComponent()->GetSettings()->GetBool(CSettings::SETTING_SERVICES_WEBSERVERSSL) &&
       MHD_is_feature_supported(MHD_FEATURE_SSL) == MHD_YES &&
       LoadCert(m_key, m_cert))
     // SSL enabled
     return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
+                          threadingFlags
                           | MHD_USE_DEBUG /* Print MHD error messages to log */
                           | MHD_USE_SSL
                           ,
@@ -1135,17 +1348,12 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           MHD_OPTION_HTTPS_MEM_KEY, m_key.c_str(),
                           MHD_OPTION_HTTPS_MEM_CERT, m_cert.c_str(),
                           MHD_OPTION_HTTPS_PRIORITIES, ciphers,
+                          MHD_OPTION_ARRAY, threadingOptions,
                           MHD_OPTION_END);
 
   // No SSL
   return MHD_start_daemon(flags |
-                          // one thread per connection
-                          // WARNING: set MHD_OPTION_CONNECTION_TIMEOUT to something higher than 1
-                          // otherwise on libmicrohttpd 0.4.4-1 it spins a busy loop
-                          MHD_USE_THREAD_PER_CONNECTION
-#if (MHD_VERSION >= 0x00095207)
-                          | MHD_USE_INTERNAL_POLLING_THREAD /* MHD_USE_THREAD_PER_CONNECTION must be used only with MHD_USE_INTERNAL_POLLING_THREAD since 0.9.54 */
-#endif
+                          threadingFlags
                           | MHD_USE_DEBUG /* Print MHD error messages to log */
                           ,
                           port,
@@ -1159,6 +1367,7 @@ struct MHD_Daemon* CWebServer::StartMHD(unsigned int flags, int port)
                           MHD_OPTION_URI_LOG_CALLBACK, &CWebServer::UriRequestLogger, this,
                           MHD_OPTION_EXTERNAL_LOGGER, &logFromMHD, 0,
                           MHD_OPTION_THREAD_STACK_SIZE, m_thread_stacksize,
+                          MHD_OPTION_ARRAY, threadingOptions,
                           MHD_OPTION_END);
 }
 
@@ -1167,6 +1376,15 @@ bool CWebServer::Start(uint16_t port, const std::string &username, const std::st
   SetCredentials(username, password);
   if (!m_running)
   {
+    m_threadPoolSize = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_webserverThreadPoolSize;
+#if (MHD_VERSION < 0x00095207)
+    if (m_threadPoolSize > 0)
+    {
+      CLog::Log(LOGWARNING, "CWebServer[%hu]: Thread pool mode requires libmicrohttpd 0.9.52 or later, using a thread per connection", port);
+      m_threadPoolSize = 0;
+    }
+#endif
+
     int v6testSock;
     if ((v6testSock = socket(AF_INET6, SOCK_STREAM, 0)) >= 0)
     {
@@ -1179,7 +1397,10 @@ bool CWebServer::Start(uint16_t port, const std::string &username, const std::st
     if (m_running)
     {
       m_port = port;
-      CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started", m_port);
+      if (m_threadPoolSize > 0)
+        CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started with a pool of %u threads", m_port, m_threadPoolSize);
+      else
+        CLog::Log(LOGNOTICE, "CWebServer[%hu]: Started", m_port);
     }
     else
       CLog::Log(LOGERROR, "CWebServer[%hu]: Failed to start", port);
@@ -1193,6 +1414,30 @@ bool CWebServer::Stop()
   if (!m_running)
     return true;
 
+  // libmicrohttpd panics if connections are still suspended when stopping the daemons. fail all
+  // downloads reading ahead so that none is suspended again and resume the ones waiting for data
+  {
+    CSingleLock lock(m_critSection);
+    m_stopping = true;
+    for (const auto& it : m_readAheads)
+    {
+      std::shared_ptr<HttpFileReadAhead> readAhead = it.lock();
+      if (!readAhead)
+        continue;
+
+      CSingleLock readAheadLock(readAhead->section);
+      readAhead->failed = true;
+#if (MHD_VERSION >= 0x00095207)
+      if (readAhead->suspended && !readAhead->closed)
+      {
+        readAhead->suspended = false;
+        MHD_resume_connection(readAhead->connection);
+      }
+#endif
+    }
+    m_readAheads.clear();
+  }
+
   if (m_daemon_ip6 != nullptr)
     MHD_stop_daemon(m_daemon_ip6);
 
@@ -1200,6 +1445,7 @@ bool CWebServer::Stop()
     MHD_stop_daemon(m_daemon_ip4);
 
   m_running = false;
+  m_stopping = false;
   CLog::Log(LOGNOTICE, "CWebServer[%hu]: Stopped", m_port);
   m_port = 0;
 
@@ -20,6 +20,7 @@ namespace XFILE
 }
 class CDateTime;
 class CVariant;
+struct HttpFileReadAhead;
 
 class CWebServer
 {
@@ -81,6 +82,11 @@ private:
 
   int CreateRedirect(struct MHD_Connection *connection, const std::string &strURL, struct MHD_Response *&response) const;
   int CreateFileDownloadResponse(const std::shared_ptr<IHTTPRequestHandler>& handler, struct MHD_Response *&response) const;
+  /*!
+   \brief Create a response serving part of a local file straight from its file descriptor.
+   \return the response or nullptr if the file is not a regular file on a local filesystem.
+   */
+  struct MHD_Response* CreateFileDescriptorResponse(const std::string &filePath, uint64_t offset, uint64_t length) const;
   int CreateErrorResponse(struct MHD_Connection *connection, int responseType, HTTPMethod method, struct MHD_Response *&response) const;
   int CreateMemoryDownloadResponse(struct MHD_Connection *connection, const void *data, size_t size, bool free, bool copy, struct MHD_Response *&response) const;
 
@@ -99,6 +105,14 @@ private:
 
   static ssize_t ContentReaderCallback (void *cls, uint64_t pos, char *buf, size_t max);
   static void ContentReaderFreeCallback(void *cls);
+  /*!
+   \brief Serve file data read ahead in the background.
+   Used in thread pool mode so that pool threads don't block on (possibly slow) file reads. If no
+   data is available for the current write position a read is started and the connection is
+   suspended until it completes.
+   \return number of bytes copied into buf, 0 if the connection was suspended or -1 on error.
+   */
+  static ssize_t ReadAheadContent(void *cls, char *buf, size_t max);
 
   static int AnswerToConnection (void *cls, struct MHD_Connection *connection,
                         const char *url, const char *method,
@@ -116,6 +130,9 @@ private:
   struct MHD_Daemon *m_daemon_ip4 = nullptr;
   bool m_running = false;
   size_t m_thread_stacksize = 0;
+  unsigned int m_threadPoolSize = 0;
+  mutable std::vector<std::weak_ptr<HttpFileReadAhead>> m_readAheads; ///< read-ahead state of all file downloads in thread pool mode
+  mutable bool m_stopping = false;
   bool m_authenticationRequired = false;
   std::string m_authenticationUsername;
   std::string m_authenticationPassword;
@@ -14,6 +14,7 @@
 #include <stdlib.h>
 
 #include <gtest/gtest.h>
+#include "ServiceBroker.h"
 #include "URL.h"
 #include "filesystem/CurlFile.h"
 #include "filesystem/File.h"
@@ -21,14 +22,20 @@
 #include "network/WebServer.h"
 #include "network/httprequesthandler/HTTPVfsHandler.h"
 #include "network/httprequesthandler/HTTPJsonRpcHandler.h"
+#include "settings/AdvancedSettings.h"
 #include "settings/MediaSourceSettings.h"
+#include "settings/SettingsComponent.h"
 #include "test/TestUtils.h"
+#include "threads/Event.h"
+#include "threads/SystemClock.h"
+#include "utils/JobManager.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/StringUtils.h"
 #include "utils/URIUtils.h"
 #include "utils/Variant.h"
 
 #include <random>
+#include <thread>
 
 using namespace XFILE;
 
@@ -40,6 +47,10 @@ using namespace XFILE;
 #define TEST_FILES_DATA_RANGES  "range1;range2;range3"
 #define TEST_FILES_HTML         TEST_FILES_DATA ".html"
 #define TEST_FILES_RANGES       TEST_FILES_DATA "-ranges.txt"
+#define TEST_FILES_READAHEAD    TEST_FILES_DATA "-readahead.zip"
+#define TEST_FILES_READAHEAD_ENTRY  TEST_FILES_DATA "-readahead.txt"
+// the entry in the archive consists of 640 blocks of 1 KB, filled with 'a' to 'z' in turn
+#define TEST_FILES_READAHEAD_BLOCKS 640
 
 class TestWebServer : public testing::Test
 {
@@ -121,6 +132,37 @@ protected:
     return GetUrl(path);
   }
 
+  std::string GetUrlOfTestFileInArchive(const std::string& archive, const std::string& testFile)
+  {
+    // files in archives have no file descriptor, so they are served through the content reader
+    CURL archiveUrl = URIUtils::CreateArchivePath("zip", CURL(URIUtils::AddFileToFolder(sourcePath, archive)), testFile);
+    std::string path = CURL::Encode(archiveUrl.Get());
+    path = URIUtils::AddFileToFolder("vfs", path);
+
+    return GetUrl(path);
+  }
+
+  static std::string GetReadAheadTestFileContent()
+  {
+    std::string content;
+    for (unsigned int block = 0; block < TEST_FILES_READAHEAD_BLOCKS; block++)
+      content.append(1024, static_cast<char>('a' + block % 26));
+
+    return content;
+  }
+
+  void RestartInThreadPoolMode()
+  {
+    // restart the webserver with a thread pool, file data is then read ahead in the background
+    const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+    const unsigned int threadPoolSize = advancedSettings->m_webserverThreadPoolSize;
+    advancedSettings->m_webserverThreadPoolSize = 2;
+    webserver.Stop();
+    const bool started = webserver.Start(webserverPort, "", "");
+    advancedSettings->m_webserverThreadPoolSize = threadPoolSize;
+    ASSERT_TRUE(started);
+  }
+
   bool GetLastModifiedOfTestFile(const std::string& testFile, CDateTime& lastModified)
   {
     CFile file;
@@ -832,6 +874,73 @@ TEST_F(TestWebServer, CanGetRangedFileRangeFirstSecondLast)
   CheckRangesTestFileResponse(curl, result, ranges);
 }
 
+TEST_F(TestWebServer, CanGetFileInThreadPoolMode)
+{
+  ASSERT_NO_FATAL_FAILURE(RestartInThreadPoolMode());
+
+  // get the whole file, it's larger than a read ahead chunk so the connection is suspended and
+  // resumed several times
+  const std::string readAheadContent = GetReadAheadTestFileContent();
+  std::string result;
+  CCurlFile curl;
+  ASSERT_TRUE(curl.Get(GetUrlOfTestFileInArchive(TEST_FILES_READAHEAD, TEST_FILES_READAHEAD_ENTRY), result));
+  ASSERT_EQ(readAheadContent.size(), result.size());
+  EXPECT_TRUE(readAheadContent == result);
+
+  // get a range spanning a chunk boundary
+  const unsigned int rangeStart = 255 * 1024 + 100;
+  const unsigned int rangeEnd = 513 * 1024 + 100;
+  CCurlFile curlRange;
+  curlRange.SetRequestHeader(MHD_HTTP_HEADER_RANGE, StringUtils::Format("bytes=%u-%u", rangeStart, rangeEnd));
+  ASSERT_TRUE(curlRange.Get(GetUrlOfTestFileInArchive(TEST_FILES_READAHEAD, TEST_FILES_READAHEAD_ENTRY), result));
+  EXPECT_TRUE(readAheadContent.substr(rangeStart, rangeEnd - rangeStart + 1) == result);
+
+  // get several ranges of a file
+  const std::string rangedFileContent = TEST_FILES_DATA_RANGES;
+  std::vector<std::string> rangedContent = StringUtils::Split(TEST_FILES_DATA_RANGES, ";");
+  const std::string range = StringUtils::Format("bytes=0-%u,-%u", static_cast<unsigned int>(rangedContent.front().size() - 1),
+    static_cast<unsigned int>(rangedContent.back().size()));
+
+  CHttpRanges ranges;
+  ASSERT_TRUE(ranges.Parse(range, rangedFileContent.size()));
+
+  CCurlFile curlRanged;
+  curlRanged.SetRequestHeader(MHD_HTTP_HEADER_RANGE, range);
+  ASSERT_TRUE(curlRanged.Get(GetUrlOfTestFile(TEST_FILES_RANGES), result));
+  CheckRangesTestFileResponse(curlRanged, result, ranges);
+
+  EXPECT_TRUE(webserver.Stop());
+}
+
+TEST_F(TestWebServer, CanStopWithSuspendedConnectionInThreadPoolMode)
+{
+  ASSERT_NO_FATAL_FAILURE(RestartInThreadPoolMode());
+
+  // occupy all job manager workers so that the read ahead can't start and the download stays
+  // suspended waiting for data
+  CEvent readAheadBlocked(true);
+  for (unsigned int worker = 0; worker < 5; worker++)
+    CJobManager::GetInstance().Submit([&readAheadBlocked]() { readAheadBlocked.Wait(); }, CJob::PRIORITY_HIGH);
+
+  std::string result;
+  std::thread download([this, &result]() {
+    CCurlFile curl;
+    curl.Get(GetUrlOfTestFileInArchive(TEST_FILES_READAHEAD, TEST_FILES_READAHEAD_ENTRY), result);
+  });
+
+  // give the request time to reach the webserver
+  XbmcThreads::ThreadSleep(500);
+
+  // stopping must neither hang nor make libmicrohttpd panic about the suspended connection
+  const bool stopped = webserver.Stop();
+  download.join();
+  readAheadBlocked.Set();
+
+  EXPECT_TRUE(stopped);
+  EXPECT_FALSE(webserver.IsStarted());
+  EXPECT_LT(result.size(), GetReadAheadTestFileContent().size());
+}
+
 TEST_F(TestWebServer, CanGetCachedRangedFileWithOlderIfRange)
 {
   const std::string rangedFileContent = TEST_FILES_DATA_RANGES;
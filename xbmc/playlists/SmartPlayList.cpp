@@ -13,6 +13,8 @@
 #include "filesystem/File.h"
 #include "filesystem/SmartPlaylistDirectory.h"
 #include "guilib/LocalizeStrings.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/DatabaseUtils.h"
 #include "utils/JSONVariantParser.h"
 #include "utils/JSONVariantWriter.h"
@@ -25,6 +27,7 @@
 #include "utils/log.h"
 
 #include <cstdlib>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -1080,6 +1083,127 @@ void CSmartPlaylistRuleCombination::AddRule(const CSmartPlaylistRule &rule)
   m_rules.push_back(ptr);
 }
 
+CSmartPlaylistRuleCombination CSmartPlaylistRuleCombination::Clone() const
+{
+  CSmartPlaylistRuleCombination clone;
+  clone.m_type = m_type;
+  for (const auto &rule : m_rules)
+    clone.m_rules.push_back(std::make_shared<CSmartPlaylistRule>(*std::static_pointer_cast<CSmartPlaylistRule>(rule)));
+  for (const auto &combination : m_combinations)
+  {
+    auto playlistCombination = std::static_pointer_cast<CSmartPlaylistRuleCombination>(combination);
+    clone.m_combinations.push_back(std::make_shared<CSmartPlaylistRuleCombination>(playlistCombination->Clone()));
+  }
+
+  return clone;
+}
+
+namespace
+{
+
+/*!
+ \brief Cache of smart playlist files which have already been read.
+ Opening a library node or a playlist which references other playlists reads (and parses) the
+ same files over and over again, e.g. to look up playlists by name. The cache keeps the name and
+ type of every file and the parsed playlist of every file that has been loaded completely.
+ Entries are validated against the modification time and size of the file.
+ */
+class CSmartPlaylistFileCache
+{
+public:
+  static CSmartPlaylistFileCache& GetInstance()
+  {
+    static CSmartPlaylistFileCache cache;
+    return cache;
+  }
+
+  bool GetName(const std::string &path, const struct __stat64 &st, std::string &name, std::string &type)
+  {
+    CSingleLock lock(m_critSection);
+    const CacheEntry *entry = Find(path, st);
+    if (entry == nullptr)
+      return false;
+
+    name = entry->name;
+    type = entry->type;
+    return true;
+  }
+
+  void SetName(const std::string &path, const struct __stat64 &st, const std::string &name, const std::string &type)
+  {
+    CSingleLock lock(m_critSection);
+    CacheEntry &entry = m_entries[path];
+    if (entry.mtime != st.st_mtime || entry.size != st.st_size)
+      entry.loaded = false;
+    entry.mtime = st.st_mtime;
+    entry.size = st.st_size;
+    entry.name = name;
+    entry.type = type;
+  }
+
+  bool GetPlaylist(const std::string &path, const struct __stat64 &st, CSmartPlaylist &playlist)
+  {
+    CSingleLock lock(m_critSection);
+    const CacheEntry *entry = Find(path, st);
+    if (entry == nullptr || !entry->loaded)
+      return false;
+
+    playlist = entry->playlist;
+    return true;
+  }
+
+  void SetPlaylist(const std::string &path, const struct __stat64 &st, const CSmartPlaylist &playlist)
+  {
+    CSingleLock lock(m_critSection);
+    CacheEntry &entry = m_entries[path];
+    entry.mtime = st.st_mtime;
+    entry.size = st.st_size;
+    entry.name = playlist.GetName();
+    entry.type = playlist.GetType();
+    entry.playlist = playlist;
+    entry.loaded = true;
+  }
+
+private:
+  CSmartPlaylistFileCache() = default;
+
+  struct CacheEntry
+  {
+    time_t mtime = 0;
+    int64_t size = -1;
+    std::string name;
+    std::string type;
+    bool loaded = false;
+    CSmartPlaylist playlist;
+  };
+
+  const CacheEntry* Find(const std::string &path, const struct __stat64 &st) const
+  {
+    auto it = m_entries.find(path);
+    if (it == m_entries.end() || it->second.mtime != st.st_mtime || it->second.size != st.st_size)
+      return nullptr;
+
+    return &it->second;
+  }
+
+  CCriticalSection m_critSection;
+  std::map<std::string, CacheEntry> m_entries;
+};
+
+/*!
+ \brief Stat a smart playlist file to validate cache entries.
+ \return false if the file can't be cached because its modification time is unknown
+ */
+bool StatPlaylistFile(const CURL &url, struct __stat64 &st)
+{
+  if (CFile::Stat(url, &st) != 0)
+    return false;
+
+  return st.st_mtime != 0;
+}
+
+} // unnamed namespace
+
 CSmartPlaylist::CSmartPlaylist()
 {
   Reset();
@@ -1087,9 +1211,17 @@ CSmartPlaylist::CSmartPlaylist()
 
 bool CSmartPlaylist::OpenAndReadName(const CURL &url)
 {
+  struct __stat64 st;
+  bool cacheable = StatPlaylistFile(url, st);
+  if (cacheable && CSmartPlaylistFileCache::GetInstance().GetName(url.Get(), st, m_playlistName, m_playlistType))
+    return !m_playlistName.empty();
+
   if (readNameFromPath(url) == NULL)
     return false;
 
+  if (cacheable)
+    CSmartPlaylistFileCache::GetInstance().SetName(url.Get(), st, m_playlistName, m_playlistType);
+
   return !m_playlistName.empty();
 }
 
@@ -1177,13 +1309,34 @@ bool CSmartPlaylist::load(const TiXmlNode *root)
 
 bool CSmartPlaylist::Load(const CURL &url)
 {
-  return load(readNameFromPath(url));
+  struct __stat64 st;
+  bool cacheable = StatPlaylistFile(url, st);
+  if (cacheable && CSmartPlaylistFileCache::GetInstance().GetPlaylist(url.Get(), st, *this))
+  {
+    // don't share the rules with the cached playlist
+    m_ruleCombination = m_ruleCombination.Clone();
+    return true;
+  }
+
+  if (!load(readNameFromPath(url)))
+    return false;
+
+  if (cacheable)
+  {
+    CSmartPlaylist cached(*this);
+    cached.m_ruleCombination = m_ruleCombination.Clone();
+    // the parsed document isn't needed anymore
+    cached.m_xmlDoc.Clear();
+    CSmartPlaylistFileCache::GetInstance().SetPlaylist(url.Get(), st, cached);
+  }
+
+  return true;
 }
 
 bool CSmartPlaylist::Load(const std::string &path)
 {
   const CURL pathToUrl(path);
-  return load(readNameFromPath(pathToUrl));
+  return Load(pathToUrl);
 }
 
 bool CSmartPlaylist::Load(const CVariant &obj)
@@ -82,6 +82,10 @@ public:
                          std::vector<std::string> &virtualFolders) const;
 
   void AddRule(const CSmartPlaylistRule &rule);
+
+  /*! \brief Create a copy of the combination which doesn't share any rules or combinations with it
+   */
+  CSmartPlaylistRuleCombination Clone() const;
 };
 
 class CSmartPlaylist : public IDatabaseQueryRuleFactory
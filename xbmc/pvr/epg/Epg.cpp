@@ -19,8 +19,10 @@
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -217,11 +219,12 @@ std::shared_ptr<CPVREpgInfoTag> CPVREpg::GetTagBetween(const CDateTime& beginTim
   std::shared_ptr<CPVREpgInfoTag> tag;
 
   CSingleLock lock(m_critSection);
-  for (const auto& epgTag : m_tags)
+  // m_tags is sorted by start time, only tags starting within the given range need to be checked
+  for (auto it = m_tags.lower_bound(beginTime); it != m_tags.end() && it->first <= endTime; ++it)
   {
-    if (epgTag.second->StartAsUTC() >= beginTime && epgTag.second->EndAsUTC() <= endTime)
+    if (it->second->EndAsUTC() <= endTime)
     {
-      tag = epgTag.second;
+      tag = it->second;
       break;
     }
   }
@@ -266,6 +269,8 @@ std::vector<std::shared_ptr<CPVREpgInfoTag>> CPVREpg::GetTimeline(
 
   CSingleLock lock(m_critSection);
 
+  // events may overlap, so an event starting long before minEventEnd may still be running. all
+  // events have to be checked, the map's start time ordering isn't enough to skip ahead
   CDateTime lastEnd = minEventEnd;
   for (const auto& epgTag : m_tags)
   {
@@ -593,6 +598,9 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
 
   database->Lock();
 
+  const unsigned int iStart = XbmcThreads::SystemClockMillis();
+  size_t iTags = 0;
+
   {
     CSingleLock lock(m_critSection);
     bool bEpgIdChanged = false;
@@ -606,11 +614,19 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
       }
     }
 
+    std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
+    tags.reserve(m_deletedTags.size());
     for (const auto& tag : m_deletedTags)
-      database->Delete(*tag.second);
+      tags.emplace_back(tag.second);
+    database->QueueDeleteQueries(tags);
+    iTags += tags.size();
 
+    tags.clear();
+    tags.reserve(m_changedTags.size());
     for (const auto& tag : m_changedTags)
-      tag.second->Persist(database, false);
+      tags.emplace_back(tag.second);
+    database->QueuePersistQueries(tags);
+    iTags += tags.size();
 
     if (m_bUpdateLastScanTime)
       database->PersistLastEpgScanTime(m_iEpgID, m_lastScanTime, true);
@@ -631,6 +647,14 @@ bool CPVREpg::Persist(const std::shared_ptr<CPVREpgDatabase>& database)
   bool bRet = database->CommitInsertQueries();
 
   database->Unlock();
+
+  if (iTags > 0)
+  {
+    const unsigned int iDuration = XbmcThreads::SystemClockMillis() - iStart;
+    CLog::LogFC(LOGDEBUG, LOGEPG, "Persisted %zu tags of EPG '%s' in %u ms (%u tags/s)", iTags,
+                m_strName.c_str(), iDuration, static_cast<unsigned int>(iTags * 1000 / std::max(iDuration, 1u)));
+  }
+
   return bRet;
 }
 
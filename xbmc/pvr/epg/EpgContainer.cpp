@@ -20,9 +20,16 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/Settings.h"
 #include "settings/SettingsComponent.h"
+#include "threads/Event.h"
+#include "threads/IRunnable.h"
 #include "threads/SingleLock.h"
+#include "threads/SystemClock.h"
+#include "threads/Thread.h"
 #include "utils/log.h"
 
+#include <algorithm>
+#include <functional>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -161,6 +168,17 @@ void CPVREpgContainer::Clear()
     Start(true);
 }
 
+class CEpgUpdateRunner : public IRunnable
+{
+public:
+  explicit CEpgUpdateRunner(const std::function<void()>& update) : m_update(update) {}
+
+  void Run() override { m_update(); }
+
+private:
+  std::function<void()> m_update;
+};
+
 class CPVREpgContainerStartJob : public CJob
 {
 public:
@@ -662,39 +680,116 @@ bool CPVREpgContainer::UpdateEPG(bool bOnlyPending /* = false */)
   if (bShowProgress && !bOnlyPending)
     progressHandler = new CPVRGUIProgressHandler(g_localizeStrings.Get(19004)); // Importing guide from clients
 
-  /* load or update all EPG tables */
-  unsigned int iCounter = 0;
-  const std::shared_ptr<CPVREpgDatabase> database = UseDatabase() ? GetEpgDatabase() : nullptr;
-  for (const auto& epgEntry : m_epgIdToEpgMap)
+  /* group the EPG tables by client. tables of one client are updated one after another, different
+     clients are updated concurrently so that a slow backend does not hold up all the others. */
+  std::map<int, std::vector<std::shared_ptr<CPVREpg>>> clientEpgs;
+  size_t iTotal = 0;
   {
-    if (InterruptUpdate())
+    CSingleLock lock(m_critSection);
+    for (const auto& epgEntry : m_epgIdToEpgMap)
     {
-      bInterrupted = true;
-      break;
+      const std::shared_ptr<CPVREpg> epg = epgEntry.second;
+      if (!epg)
+        continue;
+
+      clientEpgs[epg->GetChannelData()->ClientId()].emplace_back(epg);
+      ++iTotal;
     }
+  }
 
-    const std::shared_ptr<CPVREpg> epg = epgEntry.second;
-    if (!epg)
-      continue;
+  auto itNextClient = clientEpgs.cbegin();
+  unsigned int iCounter = 0;
+  CCriticalSection updateLock;
+  CEvent interruptEvent(true);
 
-    if (bShowProgress && !bOnlyPending)
-      progressHandler->UpdateProgress(epg->Name(), ++iCounter, m_epgIdToEpgMap.size());
+  const std::shared_ptr<CPVREpgDatabase> database = UseDatabase() ? GetEpgDatabase() : nullptr;
+  const int iUpdateTime = m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60;
+  const int iPastDays = m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY);
+  const unsigned int iRequestInterval = static_cast<unsigned int>(std::max(0, advancedSettings->m_iEpgClientRequestInterval));
 
-    if ((!bOnlyPending || epg->UpdatePending()) &&
-        epg->Update(start,
-                    end,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_EPGUPDATE) * 60,
-                    m_settings.GetIntValue(CSettings::SETTING_EPG_PAST_DAYSTODISPLAY),
-                    database,
-                    bOnlyPending))
+  /* load or update all EPG tables of the next client not yet taken by another worker */
+  const auto updateClients = [&]() {
+    while (true)
     {
-      iUpdatedTables++;
+      std::vector<std::shared_ptr<CPVREpg>> epgs;
+      {
+        CSingleLock lock(updateLock);
+        if (itNextClient == clientEpgs.cend() || bInterrupted)
+          return;
+
+        epgs = (*itNextClient).second;
+        ++itNextClient;
+      }
+
+      bool bFirstRequest = true;
+      for (const auto& epg : epgs)
+      {
+        if (InterruptUpdate())
+        {
+          CSingleLock lock(updateLock);
+          bInterrupted = true;
+          interruptEvent.Set();
+          return;
+        }
+
+        if (progressHandler)
+        {
+          unsigned int iCurrent = 0;
+          {
+            CSingleLock lock(updateLock);
+            iCurrent = ++iCounter;
+          }
+          progressHandler->UpdateProgress(epg->Name(), iCurrent, iTotal);
+        }
+
+        if (bOnlyPending && !epg->UpdatePending())
+          continue;
+
+        // rate limit the requests to a single client
+        if (!bFirstRequest && iRequestInterval > 0)
+          interruptEvent.WaitMSec(iRequestInterval);
+
+        bFirstRequest = false;
+
+        if (epg->Update(start, end, iUpdateTime, iPastDays, database, bOnlyPending))
+        {
+          CSingleLock lock(updateLock);
+          iUpdatedTables++;
+        }
+        else if (!epg->IsValid())
+        {
+          CSingleLock lock(updateLock);
+          invalidTables.emplace_back(epg);
+        }
+      }
     }
-    else if (!epg->IsValid())
+  };
+
+  const size_t iWorkers = std::min(clientEpgs.size(),
+                                   static_cast<size_t>(std::max(1, advancedSettings->m_iEpgUpdateMaxClientThreads)));
+  if (iWorkers > 1)
+  {
+    // the container's own thread is one of the workers
+    CEpgUpdateRunner runner(updateClients);
+    std::vector<std::unique_ptr<CThread>> workers;
+    for (size_t i = 1; i < iWorkers; ++i)
     {
-      invalidTables.push_back(epg);
+      workers.emplace_back(new CThread(&runner, "EPGUpdater"));
+      workers.back()->Create();
     }
+
+    updateClients();
+
+    for (const auto& worker : workers)
+      worker->Join(XbmcThreads::EndTime::InfiniteValue);
   }
+  else
+  {
+    updateClients();
+  }
+
+  CLog::LogFC(LOGDEBUG, LOGEPG, "Updated %u of %zu EPG tables from %zu clients using %zu workers",
+              iUpdatedTables, iTotal, clientEpgs.size(), iWorkers);
 
   if (bShowProgress && !bOnlyPending)
     progressHandler->DestroyProgress();
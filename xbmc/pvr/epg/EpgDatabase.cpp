@@ -15,11 +15,14 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/SingleLock.h"
+#include "utils/StringUtils.h"
 #include "utils/log.h"
 
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace dbiplus;
@@ -357,16 +360,24 @@ int CPVREpgDatabase::Persist(const CPVREpg& epg, bool bQueueWrite /* = false */)
   return iReturn;
 }
 
-int CPVREpgDatabase::Persist(const CPVREpgInfoTag& tag, bool bSingleUpdate /* = true */)
+namespace
+{
+// maximum number of tags written or deleted by a single statement
+constexpr size_t PERSIST_BATCH_SIZE = 100;
+constexpr size_t DELETE_BATCH_SIZE = 500; // ids only, so the statement stays short
+// maximum length of the values written by a single statement. tags with long plots or cast lists
+// must not push it over SQLite's SQLITE_MAX_SQL_LENGTH (1000000) or MySQL's max_allowed_packet,
+// whose default has been as low as 1 MB
+constexpr size_t PERSIST_BATCH_LENGTH = 256 * 1024;
+
+const char* EPGTAGS_COLUMNS = "idEpg, iStartTime, "
+    "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
+    "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
+    "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid";
+} // unnamed namespace
+
+std::string CPVREpgDatabase::GetTagValuesSQL(const CPVREpgInfoTag& tag) const
 {
-  int iReturn(-1);
-
-  if (tag.EpgID() <= 0)
-  {
-    CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag.Title().c_str());
-    return iReturn;
-  }
-
   time_t iStartTime, iEndTime;
   tag.StartAsUTC().GetAsTime(iStartTime);
   tag.EndAsUTC().GetAsTime(iEndTime);
@@ -375,47 +386,41 @@ int CPVREpgDatabase::Persist(const CPVREpgInfoTag& tag, bool bSingleUpdate /* =
   if (tag.FirstAiredAsUTC().IsValid())
     tag.FirstAiredAsUTC().GetAsTime(iFirstAired);
 
-  int iBroadcastId = tag.DatabaseID();
-  std::string strQuery;
-
   /* Only store the genre string when needed */
   std::string strGenre = (tag.GenreType() == EPG_GENRE_USE_STRING || tag.GenreSubType() == EPG_GENRE_USE_STRING) ? tag.DeTokenize(tag.Genre()) : "";
 
-  CSingleLock lock(m_critSection);
+  std::string strValues = PrepareSQL("(%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i",
+      tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
+      tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
+      tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
+      tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
+      tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
+      static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), false /* unused */,
+      tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
+      tag.UniqueBroadcastID());
 
-  if (iBroadcastId < 0)
-  {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
-        tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
-        tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), false /* unused */,
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
-        tag.UniqueBroadcastID());
-  }
-  else
+  if (tag.DatabaseID() >= 0)
+    strValues += PrepareSQL(", %i", tag.DatabaseID());
+
+  return strValues + ")";
+}
+
+int CPVREpgDatabase::Persist(const CPVREpgInfoTag& tag, bool bSingleUpdate /* = true */)
+{
+  int iReturn(-1);
+
+  if (tag.EpgID() <= 0)
   {
-    strQuery = PrepareSQL("REPLACE INTO epgtags (idEpg, iStartTime, "
-        "iEndTime, sTitle, sPlotOutline, sPlot, sOriginalTitle, sCast, sDirector, sWriter, iYear, sIMDBNumber, "
-        "sIconPath, iGenreType, iGenreSubType, sGenre, iFirstAired, iParentalRating, iStarRating, bNotify, iSeriesId, "
-        "iEpisodeId, iEpisodePart, sEpisodeName, iFlags, sSeriesLink, iBroadcastUid, idBroadcast) "
-        "VALUES (%u, %u, %u, '%s', '%s', '%s', '%s', '%s', '%s', '%s', %i, '%s', '%s', %i, %i, '%s', %u, %i, %i, %i, %i, %i, %i, '%s', %i, '%s', %i, %i);",
-        tag.EpgID(), static_cast<unsigned int>(iStartTime), static_cast<unsigned int>(iEndTime),
-        tag.Title().c_str(), tag.PlotOutline().c_str(), tag.Plot().c_str(),
-        tag.OriginalTitle().c_str(), tag.DeTokenize(tag.Cast()).c_str(), tag.DeTokenize(tag.Directors()).c_str(),
-        tag.DeTokenize(tag.Writers()).c_str(), tag.Year(), tag.IMDBNumber().c_str(),
-        tag.Icon().c_str(), tag.GenreType(), tag.GenreSubType(), strGenre.c_str(),
-        static_cast<unsigned int>(iFirstAired), tag.ParentalRating(), tag.StarRating(), false /* unused */,
-        tag.SeriesNumber(), tag.EpisodeNumber(), tag.EpisodePart(), tag.EpisodeName().c_str(), tag.Flags(), tag.SeriesLink().c_str(),
-        tag.UniqueBroadcastID(), iBroadcastId);
+    CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag.Title().c_str());
+    return iReturn;
   }
 
+  CSingleLock lock(m_critSection);
+
+  std::string strQuery = StringUtils::Format("REPLACE INTO epgtags (%s%s) VALUES %s;", EPGTAGS_COLUMNS,
+                                             tag.DatabaseID() < 0 ? "" : ", idBroadcast",
+                                             GetTagValuesSQL(tag).c_str());
+
   if (bSingleUpdate)
   {
     if (ExecuteQuery(strQuery))
@@ -430,6 +435,81 @@ int CPVREpgDatabase::Persist(const CPVREpgInfoTag& tag, bool bSingleUpdate /* =
   return iReturn;
 }
 
+bool CPVREpgDatabase::QueuePersistQueries(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags)
+{
+  CSingleLock lock(m_critSection);
+
+  // tags which are already in the database keep their id, so they can't share a statement with new ones
+  std::vector<std::string> newTags;
+  std::vector<std::string> existingTags;
+  size_t newTagsLength = 0;
+  size_t existingTagsLength = 0;
+  bool bReturn = true;
+
+  auto queue = [this, &bReturn](std::vector<std::string>& values, size_t& length, bool bWithId) {
+    if (values.empty())
+      return;
+
+    bReturn &= QueueInsertQuery(StringUtils::Format("REPLACE INTO epgtags (%s%s) VALUES %s;", EPGTAGS_COLUMNS,
+                                                    bWithId ? ", idBroadcast" : "",
+                                                    StringUtils::Join(values, ", ").c_str()));
+    values.clear();
+    length = 0;
+  };
+
+  for (const auto& tag : tags)
+  {
+    if (tag->EpgID() <= 0)
+    {
+      CLog::LogF(LOGERROR, "Tag '%s' does not have a valid table", tag->Title().c_str());
+      bReturn = false;
+      continue;
+    }
+
+    bool bWithId = tag->DatabaseID() >= 0;
+    std::vector<std::string>& values = bWithId ? existingTags : newTags;
+    size_t& length = bWithId ? existingTagsLength : newTagsLength;
+    std::string tagValues = GetTagValuesSQL(*tag);
+
+    // a tag that would make the statement too long starts a new one
+    if (length + tagValues.size() > PERSIST_BATCH_LENGTH)
+      queue(values, length, bWithId);
+
+    length += tagValues.size() + 2;
+    values.emplace_back(std::move(tagValues));
+    if (values.size() >= PERSIST_BATCH_SIZE)
+      queue(values, length, bWithId);
+  }
+
+  queue(newTags, newTagsLength, false);
+  queue(existingTags, existingTagsLength, true);
+
+  return bReturn;
+}
+
+bool CPVREpgDatabase::QueueDeleteQueries(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags)
+{
+  CSingleLock lock(m_critSection);
+
+  std::vector<std::string> ids;
+  bool bReturn = true;
+
+  for (auto it = tags.begin(); it != tags.end(); ++it)
+  {
+    /* tag without a database ID was not persisted */
+    if ((*it)->DatabaseID() > 0)
+      ids.emplace_back(StringUtils::Format("%u", (*it)->DatabaseID()));
+
+    if (!ids.empty() && (ids.size() >= DELETE_BATCH_SIZE || std::next(it) == tags.end()))
+    {
+      bReturn &= QueueInsertQuery("DELETE FROM epgtags WHERE idBroadcast IN (" + StringUtils::Join(ids, ",") + ");");
+      ids.clear();
+    }
+  }
+
+  return bReturn;
+}
+
 int CPVREpgDatabase::GetLastEPGId()
 {
   CSingleLock lock(m_critSection);
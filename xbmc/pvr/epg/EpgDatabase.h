@@ -12,6 +12,7 @@
 #include "threads/CriticalSection.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 class CDateTime;
@@ -145,6 +146,22 @@ namespace PVR
      */
     int Persist(const CPVREpgInfoTag& tag, bool bSingleUpdate = true);
 
+    /*!
+     * @brief Queue the given infotags to be persisted. The tags are written with multi-row
+     * statements, which are executed together with all other queued queries.
+     * @param tags The tags to persist.
+     * @return True if the queries were queued successfully, false otherwise.
+     */
+    bool QueuePersistQueries(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags);
+
+    /*!
+     * @brief Queue the removal of the given infotags. The tags are removed with batched
+     * statements, which are executed together with all other queued queries.
+     * @param tags The tags to remove.
+     * @return True if the queries were queued successfully, false otherwise.
+     */
+    bool QueueDeleteQueries(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags);
+
     /*!
      * @return Last EPG id in the database
      */
@@ -171,6 +188,13 @@ namespace PVR
 
     int GetMinSchemaVersion() const override { return 4; }
 
+    /*!
+     * @brief Get the values of an infotag for a REPLACE INTO epgtags statement.
+     * @param tag The tag.
+     * @return The values, including the database ID if the tag has already been persisted.
+     */
+    std::string GetTagValuesSQL(const CPVREpgInfoTag& tag) const;
+
     CCriticalSection m_critSection;
   };
 }
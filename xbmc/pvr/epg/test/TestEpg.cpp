@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XBDateTime.h"
+#include "pvr/epg/Epg.h"
+#include "pvr/epg/EpgInfoTag.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace PVR;
+
+namespace
+{
+
+void AddTag(CPVREpg& epg, const CDateTime& start, const CDateTime& end)
+{
+  epg.UpdateEntry(std::make_shared<CPVREpgInfoTag>(nullptr, epg.EpgID(), start, end, false), false);
+}
+
+bool ContainsEvent(const std::vector<std::shared_ptr<CPVREpgInfoTag>>& tags,
+                   const CDateTime& start,
+                   const CDateTime& end)
+{
+  for (const auto& tag : tags)
+  {
+    if (!tag->IsGapTag() && tag->StartAsUTC() == start && tag->EndAsUTC() == end)
+      return true;
+  }
+  return false;
+}
+
+} // unnamed namespace
+
+TEST(TestEpg, GetTimeline_OverlappingEvents)
+{
+  CPVREpg epg(1, "test", "client");
+
+  // a long event overlapped by a short one that ends before the requested range
+  const CDateTime longStart(2020, 1, 1, 10, 0, 0);
+  const CDateTime longEnd(2020, 1, 1, 14, 0, 0);
+  const CDateTime shortStart(2020, 1, 1, 10, 30, 0);
+  const CDateTime shortEnd(2020, 1, 1, 11, 0, 0);
+  const CDateTime nextStart(2020, 1, 1, 12, 30, 0);
+  const CDateTime nextEnd(2020, 1, 1, 13, 0, 0);
+  AddTag(epg, longStart, longEnd);
+  AddTag(epg, shortStart, shortEnd);
+  AddTag(epg, nextStart, nextEnd);
+
+  const CDateTime timelineStart(2020, 1, 1, 0, 0, 0);
+  const CDateTime timelineEnd(2020, 1, 2, 0, 0, 0);
+  const CDateTime minEventEnd(2020, 1, 1, 12, 0, 0);
+  const CDateTime maxEventStart(2020, 1, 1, 13, 30, 0);
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags =
+      epg.GetTimeline(timelineStart, timelineEnd, minEventEnd, maxEventStart);
+
+  // the long event is still running at minEventEnd
+  EXPECT_TRUE(ContainsEvent(tags, longStart, longEnd));
+  EXPECT_FALSE(ContainsEvent(tags, shortStart, shortEnd));
+  EXPECT_TRUE(ContainsEvent(tags, nextStart, nextEnd));
+}
+
+TEST(TestEpg, GetTimeline_SortedEvents)
+{
+  CPVREpg epg(1, "test", "client");
+
+  for (int hour = 0; hour < 24; hour++)
+    AddTag(epg, CDateTime(2020, 1, 1, hour, 0, 0), CDateTime(2020, 1, 1, hour, 59, 59));
+
+  const std::vector<std::shared_ptr<CPVREpgInfoTag>> tags =
+      epg.GetTimeline(CDateTime(2020, 1, 1, 0, 0, 0), CDateTime(2020, 1, 2, 0, 0, 0),
+                      CDateTime(2020, 1, 1, 10, 30, 0), CDateTime(2020, 1, 1, 12, 30, 0));
+
+  ASSERT_EQ(3u, tags.size());
+  EXPECT_EQ(CDateTime(2020, 1, 1, 10, 0, 0), tags[0]->StartAsUTC());
+  EXPECT_EQ(CDateTime(2020, 1, 1, 11, 0, 0), tags[1]->StartAsUTC());
+  EXPECT_EQ(CDateTime(2020, 1, 1, 12, 0, 0), tags[2]->StartAsUTC());
+}
+
+TEST(TestEpg, GetTagBetween)
+{
+  CPVREpg epg(1, "test", "client");
+
+  AddTag(epg, CDateTime(2020, 1, 1, 10, 0, 0), CDateTime(2020, 1, 1, 14, 0, 0));
+  AddTag(epg, CDateTime(2020, 1, 1, 11, 0, 0), CDateTime(2020, 1, 1, 12, 0, 0));
+  AddTag(epg, CDateTime(2020, 1, 1, 12, 0, 0), CDateTime(2020, 1, 1, 15, 0, 0));
+
+  // only events lying completely within the range qualify
+  std::shared_ptr<CPVREpgInfoTag> tag =
+      epg.GetTagBetween(CDateTime(2020, 1, 1, 10, 30, 0), CDateTime(2020, 1, 1, 13, 0, 0));
+  ASSERT_TRUE(tag);
+  EXPECT_EQ(CDateTime(2020, 1, 1, 11, 0, 0), tag->StartAsUTC());
+
+  tag = epg.GetTagBetween(CDateTime(2020, 1, 1, 12, 30, 0), CDateTime(2020, 1, 1, 16, 0, 0));
+  EXPECT_FALSE(tag);
+}
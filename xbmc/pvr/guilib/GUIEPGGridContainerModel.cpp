@@ -19,6 +19,7 @@
 #include "utils/Variant.h"
 #include "utils/log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <vector>
@@ -493,56 +494,40 @@ bool CGUIEPGGridContainerModel::FreeProgrammeMemory(int firstChannel,
   if (!channelsChanged && !blocksChanged)
     return false;
 
-  // clear the grid. it will be recreated on-demand.
-  m_gridIndex.clear();
-
-  bool newChannels = false;
-
-  if (channelsChanged)
+  // drop grid items outside the new viewport. everything else will be recreated on-demand.
+  for (auto it = m_gridIndex.begin(); it != m_gridIndex.end();)
   {
-    // purge epg tags for inactive channels
-    for (auto it = m_epgItems.begin(); it != m_epgItems.end();)
+    const GridCoordinates& coordinates = (*it).first;
+    if (coordinates.channel < firstChannel || coordinates.channel > lastChannel ||
+        coordinates.block < firstBlock || coordinates.block > lastBlock)
     {
-      if ((*it).first < firstChannel || (*it).first > lastChannel)
-      {
-        it = m_epgItems.erase(it);
-        continue; // next channel
-      }
-      ++it;
+      it = m_gridIndex.erase(it);
+      continue; // next item
     }
-
-    newChannels = (firstChannel < m_firstActiveChannel) || (lastChannel > m_lastActiveChannel);
+    ++it;
   }
 
-  if (blocksChanged || newChannels)
+  for (auto it = m_epgItems.begin(); it != m_epgItems.end();)
   {
-    // clear and refetch epg tags for active channels
-    const CDateTime maxEnd = GetStartTimeForBlock(firstBlock);
-    const CDateTime minStart = GetStartTimeForBlock(lastBlock);
-    std::vector<std::shared_ptr<CPVREpgInfoTag>> tags;
-    for (int i = firstChannel; i <= lastChannel; ++i)
+    // purge epg tags for inactive channels
+    if ((*it).first < firstChannel || (*it).first > lastChannel)
     {
-      auto it = m_epgItems.find(i);
-      if (it == m_epgItems.end())
-        it = m_epgItems.insert({i, EpgTags()}).first;
-
-      if (blocksChanged || i < m_firstActiveChannel || i > m_lastActiveChannel)
-      {
-        EpgTags& epgTags = (*it).second;
-
-        (*it).second.tags.clear();
-
-        tags = m_channelItems[i]->GetPVRChannelInfoTag()->GetEPGTimeline(m_gridStart, m_gridEnd,
-                                                                         maxEnd, minStart);
-        for (const auto& tag : tags)
-          epgTags.tags.emplace_back(std::make_shared<CFileItem>(tag));
+      it = m_epgItems.erase(it);
+      continue; // next channel
+    }
 
-        epgTags.firstBlock = GetFirstEventBlock(tags.front());
-        epgTags.lastBlock = GetLastEventBlock(tags.back());
-      }
+    // purge epg tags outside the new viewport. tags for newly visible blocks will be fetched
+    // on-demand and merged with the tags still in the viewport (see GetEpgTagsBefore/After).
+    if (blocksChanged && !TrimEpgTags((*it).second, firstBlock, lastBlock))
+    {
+      it = m_epgItems.erase(it);
+      continue; // next channel
     }
+    ++it;
   }
 
+  // Note: Tags for newly visible channels will be fetched on-demand (see CreateEpgTags).
+
   m_firstActiveChannel = firstChannel;
   m_lastActiveChannel = lastChannel;
   m_firstActiveBlock = firstBlock;
@@ -551,6 +536,29 @@ bool CGUIEPGGridContainerModel::FreeProgrammeMemory(int firstChannel,
   return true;
 }
 
+bool CGUIEPGGridContainerModel::TrimEpgTags(EpgTags& epgTags, int firstBlock, int lastBlock) const
+{
+  // tags are sorted by start time and do not overlap
+  auto& tags = epgTags.tags;
+
+  const auto itFirst = std::find_if(tags.begin(), tags.end(), [this, firstBlock](const auto& item) {
+    return GetLastEventBlock(item->GetEPGInfoTag()) >= firstBlock;
+  });
+  const auto itLast = std::find_if(itFirst, tags.end(), [this, lastBlock](const auto& item) {
+    return GetFirstEventBlock(item->GetEPGInfoTag()) > lastBlock;
+  });
+
+  if (itFirst == itLast)
+    return false; // no tag left in viewport
+
+  tags.erase(itLast, tags.end());
+  tags.erase(tags.begin(), itFirst);
+
+  epgTags.firstBlock = GetFirstEventBlock(tags.front()->GetEPGInfoTag());
+  epgTags.lastBlock = GetLastEventBlock(tags.back()->GetEPGInfoTag());
+  return true;
+}
+
 void CGUIEPGGridContainerModel::FreeRulerMemory(int keepStart, int keepEnd)
 {
   if (keepStart < keepEnd)
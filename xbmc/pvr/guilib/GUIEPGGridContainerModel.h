@@ -130,6 +130,7 @@ namespace PVR
                                           int iBlock) const;
     std::shared_ptr<CFileItem> GetEpgTagsBefore(EpgTags& epgTags, int iChannel, int iBlock) const;
     std::shared_ptr<CFileItem> GetEpgTagsAfter(EpgTags& epgTags, int iChannel, int iBlock) const;
+    bool TrimEpgTags(EpgTags& epgTags, int firstBlock, int lastBlock) const;
 
     mutable EpgTagsMap m_epgItems;
 
@@ -156,7 +157,9 @@ namespace PVR
     {
       std::size_t operator()(const GridCoordinates& coordinates) const
       {
-        return std::hash<int>()(coordinates.channel) ^ std::hash<int>()(coordinates.block);
+        // channel and block are both small, non-negative ints. a plain xor would map (c, b) and
+        // (b, c) - and many more coordinates - to the same bucket.
+        return std::hash<int>()(coordinates.channel) * 31 + std::hash<int>()(coordinates.block);
       }
     };
 
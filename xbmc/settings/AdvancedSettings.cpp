@@ -165,6 +165,7 @@ void CAdvancedSettings::Initialize()
   m_videoFpsDetect = 1;
   m_maxTempo = 1.55f;
   m_videoPreferStereoStream = false;
+  m_videoPreOpenNextItem = false;
 
   m_videoDefaultLatency = 0.0;
 
@@ -296,6 +297,7 @@ void CAdvancedSettings::Initialize()
   m_iVideoLibraryRecentlyAddedItems = 25;
   m_bVideoLibraryCleanOnUpdate = false;
   m_bVideoLibraryUseFastHash = true;
+  m_bVideoLibraryUseChangeJournal = false;
   m_bVideoLibraryImportWatchedState = false;
   m_bVideoLibraryImportResumePoint = false;
   m_bVideoScannerIgnoreErrors = false;
@@ -329,6 +331,9 @@ void CAdvancedSettings::Initialize()
                                                       updateemptytagsinterval = 3600 => trigger an EPG update for every
                                                       channel without EPG data every 2 hours and trigger an EPG update
                                                       for every channel with EPG data every 1 hour. */
+  m_iEpgUpdateMaxClientThreads = 4; /* Update the EPGs of up to X PVR clients concurrently. EPGs of a single client are
+                                       always updated one after another. */
+  m_iEpgClientRequestInterval = 0; /* Wait at least X milliseconds between two EPG requests to the same PVR client */
   m_bEpgDisplayUpdatePopup = true; /* Display a progress popup while updating EPG data from clients */
   m_bEpgDisplayIncrementalUpdatePopup = false; /* Display a progress popup while doing incremental EPG updates, but
                                                   only if 'displayupdatepopup' is also enabled. */
@@ -393,12 +398,16 @@ void CAdvancedSettings::Initialize()
   m_jsonOutputCompact = true;
   m_jsonTcpPort = 9090;
 
+  m_webserverThreadPoolSize = 0;
+
   m_enableMultimediaKeys = false;
 
   m_canWindowed = true;
   m_guiVisualizeDirtyRegions = false;
   m_guiAlgorithmDirtyRegions = 3;
   m_guiSmartRedraw = false;
+  m_guiPrefetchPages = 1;
+  m_guiPrefetchMemory = 64;
   m_airTunesPort = 36666;
   m_airPlayPort = 36667;
 
@@ -700,6 +709,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "fpsdetect", m_videoFpsDetect, 0, 2);
     XMLUtils::GetFloat(pElement, "maxtempo", m_maxTempo, 1.5, 2.1);
     XMLUtils::GetBoolean(pElement, "preferstereostream", m_videoPreferStereoStream);
+    XMLUtils::GetBoolean(pElement, "preopennextitem", m_videoPreOpenNextItem);
 
     // Store global display latency settings
     TiXmlElement* pVideoLatency = pElement->FirstChildElement("latency");
@@ -775,6 +785,7 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "recentlyaddeditems", m_iVideoLibraryRecentlyAddedItems, 1, INT_MAX);
     XMLUtils::GetBoolean(pElement, "cleanonupdate", m_bVideoLibraryCleanOnUpdate);
     XMLUtils::GetBoolean(pElement, "usefasthash", m_bVideoLibraryUseFastHash);
+    XMLUtils::GetBoolean(pElement, "usechangejournal", m_bVideoLibraryUseChangeJournal);
     XMLUtils::GetString(pElement, "itemseparator", m_videoItemSeparator);
     XMLUtils::GetBoolean(pElement, "importwatchedstate", m_bVideoLibraryImportWatchedState);
     XMLUtils::GetBoolean(pElement, "importresumepoint", m_bVideoLibraryImportResumePoint);
@@ -834,6 +845,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetUInt(pElement, "tcpport", m_jsonTcpPort);
   }
 
+  pElement = pRootElement->FirstChildElement("webserver");
+  if (pElement)
+    XMLUtils::GetUInt(pElement, "threadpoolsize", m_webserverThreadPoolSize, 0, 64);
+
   pElement = pRootElement->FirstChildElement("samba");
   if (pElement)
   {
@@ -868,6 +883,10 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     CLog::SetLogLevel(m_logLevel);
   }
 
+  bool asyncLogging;
+  if (XMLUtils::GetBoolean(pRootElement, "asynclogging", asyncLogging))
+    CLog::SetAsync(asyncLogging);
+
   XMLUtils::GetString(pRootElement, "cddbaddress", m_cddbAddress);
   XMLUtils::GetBoolean(pRootElement, "addsourceontop", m_addSourceOnTop);
 
@@ -904,6 +923,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetInt(pElement, "activetagcheckinterval", m_iEpgActiveTagCheckInterval);
     XMLUtils::GetInt(pElement, "retryinterruptedupdateinterval", m_iEpgRetryInterruptedUpdateInterval);
     XMLUtils::GetInt(pElement, "updateemptytagsinterval", m_iEpgUpdateEmptyTagsInterval);
+    XMLUtils::GetInt(pElement, "updatemaxclientthreads", m_iEpgUpdateMaxClientThreads, 1, 16);
+    XMLUtils::GetInt(pElement, "clientrequestinterval", m_iEpgClientRequestInterval, 0, 10000);
     XMLUtils::GetBoolean(pElement, "displayupdatepopup", m_bEpgDisplayUpdatePopup);
     XMLUtils::GetBoolean(pElement, "displayincrementalupdatepopup", m_bEpgDisplayIncrementalUpdatePopup);
   }
@@ -1172,6 +1193,8 @@ void CAdvancedSettings::ParseSettingsFile(const std::string &file)
     XMLUtils::GetBoolean(pElement, "visualizedirtyregions", m_guiVisualizeDirtyRegions);
     XMLUtils::GetInt(pElement, "algorithmdirtyregions",     m_guiAlgorithmDirtyRegions);
     XMLUtils::GetBoolean(pElement, "smartredraw", m_guiSmartRedraw);
+    XMLUtils::GetInt(pElement, "prefetchpages", m_guiPrefetchPages, 0, 10);
+    XMLUtils::GetUInt(pElement, "prefetchmemory", m_guiPrefetchMemory);
   }
 
   std::string seekSteps;
@@ -175,6 +175,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int  m_videoFpsDetect;
     float m_maxTempo;
     bool m_videoPreferStereoStream = false;
+    bool m_videoPreOpenNextItem = false;
 
     std::string m_videoDefaultPlayer;
     float m_videoPlayCountMinimumPercent;
@@ -254,6 +255,7 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iVideoLibraryRecentlyAddedItems;
     bool m_bVideoLibraryCleanOnUpdate;
     bool m_bVideoLibraryUseFastHash;
+    bool m_bVideoLibraryUseChangeJournal;
     bool m_bVideoLibraryImportWatchedState;
     bool m_bVideoLibraryImportResumePoint;
     std::vector<std::string> m_videoEpisodeExtraArt;
@@ -273,6 +275,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     int m_iEpgActiveTagCheckInterval; // seconds
     int m_iEpgRetryInterruptedUpdateInterval; // seconds
     int m_iEpgUpdateEmptyTagsInterval; // seconds
+    int m_iEpgUpdateMaxClientThreads;
+    int m_iEpgClientRequestInterval; // milliseconds
     bool m_bEpgDisplayUpdatePopup;
     bool m_bEpgDisplayIncrementalUpdatePopup;
 
@@ -324,6 +328,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_guiVisualizeDirtyRegions;
     int  m_guiAlgorithmDirtyRegions;
     bool m_guiSmartRedraw;
+    int m_guiPrefetchPages; /*!< @brief number of pages of artwork containers keep loaded ahead of (and behind) the visible items */
+    unsigned int m_guiPrefetchMemory; /*!< @brief memory budget in MB for prefetched container artwork */
     unsigned int m_addonPackageFolderSize;
 
     unsigned int m_cacheMemSize;
@@ -334,6 +340,8 @@ class CAdvancedSettings : public ISettingCallback, public ISettingsHandler
     bool m_jsonOutputCompact;
     unsigned int m_jsonTcpPort;
 
+    unsigned int m_webserverThreadPoolSize; /*!< @brief number of threads serving all webserver connections, 0 to use a thread per connection */
+
     bool m_enableMultimediaKeys;
     std::vector<std::string> m_settingsFiles;
     void ParseSettingsFile(const std::string &file);
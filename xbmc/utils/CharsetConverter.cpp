@@ -18,6 +18,8 @@
 #include "utils/Utf8Utils.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 #include <fribidi.h>
 #include <iconv.h>
@@ -261,6 +263,291 @@ enum StdConversionType /* Keep it in sync with CCharsetConverter::CInnerConverte
   NumberOfStdConversionTypes /* Dummy sentinel entry */
 };
 
+namespace
+{
+
+/* Conversions between the Unicode encoding forms don't need iconv. They are done by the
+   transcoders below, which neither take the converter lock nor allocate an iconv state. */
+enum class UnicodeForm
+{
+  None = 0, /* not a Unicode form, use iconv */
+  Utf8,
+  Utf16LE,
+  Utf16BE,
+  Utf32
+};
+
+#ifdef WORDS_BIGENDIAN
+constexpr UnicodeForm Utf16Native = UnicodeForm::Utf16BE;
+#else
+constexpr UnicodeForm Utf16Native = UnicodeForm::Utf16LE;
+#endif
+
+constexpr UnicodeForm WcharForm = sizeof(wchar_t) == 4 ? UnicodeForm::Utf32 : Utf16Native;
+
+#if defined(TARGET_DARWIN)
+/* UTF-8-MAC also composes decomposed sequences, leave that to iconv */
+constexpr UnicodeForm Utf8SourceForm = UnicodeForm::None;
+#else
+constexpr UnicodeForm Utf8SourceForm = UnicodeForm::Utf8;
+#endif
+
+struct SUnicodeConversion
+{
+  UnicodeForm source;
+  UnicodeForm target;
+};
+
+const SUnicodeConversion g_unicodeConversion[NumberOfStdConversionTypes] = /* keep it in sync with enum StdConversionType */
+{
+  /* Utf8ToUtf32 */         { Utf8SourceForm,         UnicodeForm::Utf32 },
+  /* Utf32ToUtf8 */         { UnicodeForm::Utf32,     UnicodeForm::Utf8 },
+  /* Utf32ToW */            { UnicodeForm::Utf32,     WcharForm },
+  /* WToUtf32 */            { WcharForm,              UnicodeForm::Utf32 },
+  /* SubtitleCharsetToUtf8*/{ UnicodeForm::None,      UnicodeForm::None },
+  /* Utf8ToUserCharset */   { UnicodeForm::None,      UnicodeForm::None },
+  /* UserCharsetToUtf8 */   { UnicodeForm::None,      UnicodeForm::None },
+  /* Utf32ToUserCharset */  { UnicodeForm::None,      UnicodeForm::None },
+  /* WtoUtf8 */             { WcharForm,              UnicodeForm::Utf8 },
+  /* Utf16LEtoW */          { UnicodeForm::Utf16LE,   WcharForm },
+  /* Utf16BEtoUtf8 */       { UnicodeForm::Utf16BE,   UnicodeForm::Utf8 },
+  /* Utf16LEtoUtf8 */       { UnicodeForm::Utf16LE,   UnicodeForm::Utf8 },
+  /* Utf8toW */             { Utf8SourceForm,         WcharForm },
+  /* Utf8ToSystem */        { UnicodeForm::None,      UnicodeForm::None },
+  /* SystemToUtf8 */        { UnicodeForm::None,      UnicodeForm::None },
+  /* Ucs2CharsetToUtf8 */   { UnicodeForm::None,      UnicodeForm::None }
+};
+
+constexpr uint32_t InvalidChar = 0xFFFFFFFF;
+
+template<class STRING>
+bool IsUnitOf(UnicodeForm form)
+{
+  switch (form)
+  {
+  case UnicodeForm::Utf8:
+    return sizeof(typename STRING::value_type) == 1;
+  case UnicodeForm::Utf16LE:
+  case UnicodeForm::Utf16BE:
+    return sizeof(typename STRING::value_type) == 2;
+  case UnicodeForm::Utf32:
+    return sizeof(typename STRING::value_type) == 4;
+  default:
+    return false;
+  }
+}
+
+inline bool IsContinuationByte(uint8_t byte)
+{
+  return (byte & 0xC0) == 0x80;
+}
+
+/* Decodes one code point and advances pos past it. Invalid or truncated sequences yield
+   InvalidChar and advance pos by a single code unit, as iconv skips them. */
+template<class INPUT>
+uint32_t DecodeChar(UnicodeForm form, const INPUT& src, size_t& pos)
+{
+  const size_t length = src.length();
+  switch (form)
+  {
+  case UnicodeForm::Utf8:
+  {
+    const uint8_t lead = static_cast<uint8_t>(src[pos]);
+    if (lead < 0x80)
+    {
+      pos++;
+      return lead;
+    }
+
+    size_t size;
+    uint32_t c;
+    uint8_t secondMin = 0x80;
+    uint8_t secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF)
+    {
+      size = 2;
+      c = lead & 0x1F;
+    }
+    else if (lead >= 0xE0 && lead <= 0xEF)
+    {
+      size = 3;
+      c = lead & 0x0F;
+      if (lead == 0xE0)
+        secondMin = 0xA0; // overlong
+      else if (lead == 0xED)
+        secondMax = 0x9F; // surrogates
+    }
+    else if (lead >= 0xF0 && lead <= 0xF4)
+    {
+      size = 4;
+      c = lead & 0x07;
+      if (lead == 0xF0)
+        secondMin = 0x90; // overlong
+      else if (lead == 0xF4)
+        secondMax = 0x8F; // beyond U+10FFFF
+    }
+    else
+    {
+      pos++;
+      return InvalidChar;
+    }
+
+    if (pos + size > length)
+    {
+      pos++;
+      return InvalidChar;
+    }
+
+    const uint8_t second = static_cast<uint8_t>(src[pos + 1]);
+    if (second < secondMin || second > secondMax)
+    {
+      pos++;
+      return InvalidChar;
+    }
+    c = (c << 6) | (second & 0x3F);
+    for (size_t i = 2; i < size; i++)
+    {
+      const uint8_t next = static_cast<uint8_t>(src[pos + i]);
+      if (!IsContinuationByte(next))
+      {
+        pos++;
+        return InvalidChar;
+      }
+      c = (c << 6) | (next & 0x3F);
+    }
+    pos += size;
+    return c;
+  }
+  case UnicodeForm::Utf16LE:
+  case UnicodeForm::Utf16BE:
+  {
+    const bool swap = form != Utf16Native;
+    auto unitAt = [&src, swap](size_t i) {
+      const uint16_t unit = static_cast<uint16_t>(src[i]);
+      return swap ? static_cast<uint16_t>((unit << 8) | (unit >> 8)) : unit;
+    };
+
+    const uint16_t unit = unitAt(pos++);
+    if (unit < 0xD800 || unit > 0xDFFF)
+      return unit;
+    if (unit > 0xDBFF || pos >= length)
+      return InvalidChar;
+
+    const uint16_t low = unitAt(pos);
+    if (low < 0xDC00 || low > 0xDFFF)
+      return InvalidChar;
+    pos++;
+    return 0x10000 + ((static_cast<uint32_t>(unit - 0xD800) << 10) | (low - 0xDC00));
+  }
+  case UnicodeForm::Utf32:
+  {
+    const uint32_t c = static_cast<uint32_t>(src[pos++]);
+    if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+      return InvalidChar;
+    return c;
+  }
+  default:
+    pos++;
+    return InvalidChar;
+  }
+}
+
+template<class OUTPUT>
+void EncodeChar(UnicodeForm form, uint32_t c, OUTPUT& dst)
+{
+  typedef typename OUTPUT::value_type unit;
+  switch (form)
+  {
+  case UnicodeForm::Utf8:
+    if (c < 0x80)
+      dst.push_back(static_cast<unit>(c));
+    else if (c < 0x800)
+    {
+      dst.push_back(static_cast<unit>(0xC0 | (c >> 6)));
+      dst.push_back(static_cast<unit>(0x80 | (c & 0x3F)));
+    }
+    else if (c < 0x10000)
+    {
+      dst.push_back(static_cast<unit>(0xE0 | (c >> 12)));
+      dst.push_back(static_cast<unit>(0x80 | ((c >> 6) & 0x3F)));
+      dst.push_back(static_cast<unit>(0x80 | (c & 0x3F)));
+    }
+    else
+    {
+      dst.push_back(static_cast<unit>(0xF0 | (c >> 18)));
+      dst.push_back(static_cast<unit>(0x80 | ((c >> 12) & 0x3F)));
+      dst.push_back(static_cast<unit>(0x80 | ((c >> 6) & 0x3F)));
+      dst.push_back(static_cast<unit>(0x80 | (c & 0x3F)));
+    }
+    break;
+  case UnicodeForm::Utf16LE:
+  case UnicodeForm::Utf16BE:
+  {
+    const bool swap = form != Utf16Native;
+    auto push = [&dst, swap](uint16_t value) {
+      dst.push_back(static_cast<unit>(swap ? static_cast<uint16_t>((value << 8) | (value >> 8)) : value));
+    };
+
+    if (c < 0x10000)
+      push(static_cast<uint16_t>(c));
+    else
+    {
+      c -= 0x10000;
+      push(static_cast<uint16_t>(0xD800 | (c >> 10)));
+      push(static_cast<uint16_t>(0xDC00 | (c & 0x3FF)));
+    }
+    break;
+  }
+  case UnicodeForm::Utf32:
+    dst.push_back(static_cast<unit>(c));
+    break;
+  default:
+    break;
+  }
+}
+
+template<class INPUT, class OUTPUT>
+bool UnicodeConvert(UnicodeForm source, UnicodeForm target, const INPUT& strSource, OUTPUT& strDest, bool failOnInvalidChar)
+{
+  typedef typename OUTPUT::value_type unit;
+  const size_t length = strSource.length();
+  strDest.reserve(length);
+
+  size_t pos = 0;
+  while (pos < length)
+  {
+    if (source == UnicodeForm::Utf8)
+    {
+      /* copy runs of ASCII eight bytes at a time */
+      uint64_t block;
+      while (pos + sizeof(block) <= length)
+      {
+        memcpy(&block, &strSource[pos], sizeof(block));
+        if (block & UINT64_C(0x8080808080808080))
+          break;
+        for (size_t i = 0; i < sizeof(block); i++)
+          strDest.push_back(static_cast<unit>(static_cast<uint8_t>(strSource[pos + i])));
+        pos += sizeof(block);
+      }
+      if (pos >= length)
+        break;
+    }
+
+    const uint32_t c = DecodeChar(source, strSource, pos);
+    if (c == InvalidChar)
+    {
+      if (failOnInvalidChar)
+        return false;
+      continue;
+    }
+    EncodeChar(target, c, strDest);
+  }
+
+  return true;
+}
+
+} // unnamed namespace
+
 /* We don't want to pollute header file with many additional includes and definitions, so put
    here all staff that require usage of types defined in this file or in additional headers */
 class CCharsetConverter::CInnerConverter
@@ -316,6 +603,15 @@ bool CCharsetConverter::CInnerConverter::stdConvert(StdConversionType convertTyp
   if (convertType < 0 || convertType >= NumberOfStdConversionTypes)
     return false;
 
+  const SUnicodeConversion& unicodeConversion = g_unicodeConversion[convertType];
+  if (IsUnitOf<INPUT>(unicodeConversion.source) && IsUnitOf<OUTPUT>(unicodeConversion.target))
+  {
+    if (UnicodeConvert(unicodeConversion.source, unicodeConversion.target, strSource, strDest, failOnInvalidChar))
+      return true;
+    strDest.clear();
+    return false;
+  }
+
   CConverterType& convType = m_stdConversion[convertType];
   CSingleLock converterLock(convType);
 
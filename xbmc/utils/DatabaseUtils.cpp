@@ -10,6 +10,7 @@
 
 #include "dbwrappers/dataset.h"
 #include "music/MusicDatabase.h"
+#include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include "utils/log.h"
@@ -470,6 +471,47 @@ std::string DatabaseUtils::BuildLimitClause(int end, int start /* = 0 */)
   return sql.str();
 }
 
+std::string DatabaseUtils::BuildOrderByClause(const SortDescription &sortDescription, const MediaType &mediaType)
+{
+  // SortUtils compares the sort labels with the locale's collation and numbers inside them by
+  // value, which the database can't reproduce. Only sort methods whose label is made of values
+  // with a fixed format can be pushed down, others (including all methods falling back to the
+  // item's label for equal values, e.g. rating or year) are sorted in memory.
+  std::string desc;
+  if (sortDescription.sortOrder == SortOrderDescending)
+    desc = " DESC";
+
+  std::string column;
+  std::string idOrder;
+  switch (sortDescription.sortBy)
+  {
+    case SortByRandom:
+      return GetField(FieldRandom, mediaType, DatabaseQueryPartOrderBy);
+
+    case SortByDateAdded:
+      // the id is part of the sort label and sorted in the same direction
+      column = GetField(FieldDateAdded, mediaType, DatabaseQueryPartOrderBy);
+      idOrder = desc;
+      break;
+
+    case SortByLastPlayed:
+      if ((sortDescription.sortAttributes & SortAttributeIgnoreLabel) == 0)
+        return "";
+      // items played at the same time keep the order they are read in
+      column = GetField(FieldLastPlayed, mediaType, DatabaseQueryPartOrderBy);
+      break;
+
+    default:
+      return "";
+  }
+
+  std::string id = GetField(FieldId, mediaType, DatabaseQueryPartOrderBy);
+  if (column.empty() || id.empty())
+    return "";
+
+  return column + desc + ", " + id + idOrder;
+}
+
 int DatabaseUtils::GetField(Field field, const MediaType &mediaType, bool asIndex)
 {
   if (field == FieldNone || mediaType == MediaTypeNone)
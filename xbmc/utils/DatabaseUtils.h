@@ -147,6 +147,8 @@ typedef enum {
   DatabaseQueryPartOrderBy,
 } DatabaseQueryPart;
 
+struct SortDescription;
+
 typedef std::map<Field, CVariant> DatabaseResult;
 typedef std::vector<DatabaseResult> DatabaseResults;
 
@@ -165,6 +167,17 @@ public:
 
   static std::string BuildLimitClause(int end, int start = 0);
 
+  /*!
+   \brief Build the ORDER BY clause (without the ORDER BY keywords) to sort items of the given
+   media type directly in the database.
+   Only sort methods for which the database produces exactly the same order as SortUtils::Sort()
+   are supported, i.e. none that compare text. The item's id is used to make the order unique.
+   \param sortDescription the sort method, order and attributes
+   \param mediaType the media type of the items to sort
+   \return the clause or an empty string if the items have to be sorted in memory
+   */
+  static std::string BuildOrderByClause(const SortDescription &sortDescription, const MediaType &mediaType);
+
 private:
   static int GetField(Field field, const MediaType &mediaType, bool asIndex);
 };
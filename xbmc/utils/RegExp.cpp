@@ -9,12 +9,16 @@
 #include "RegExp.h"
 
 #include "log.h"
+#include "threads/CriticalSection.h"
+#include "threads/SingleLock.h"
 #include "utils/StringUtils.h"
 #include "utils/Utf8Utils.h"
 
 #include <algorithm>
+#include <list>
 #include <stdlib.h>
 #include <string.h>
+#include <unordered_map>
 
 using namespace PCRE;
 
@@ -41,6 +45,39 @@ int CRegExp::m_Utf8Supported = -1;
 int CRegExp::m_UcpSupported  = -1;
 int CRegExp::m_JitSupported  = -1;
 
+namespace
+{
+// total size of the cached patterns (expression and compiled code), the least recently used
+// ones are dropped when it is exceeded. patterns in use stay alive through their CRegExp
+constexpr size_t MAX_CACHE_SIZE = 4 * 1024 * 1024;
+// larger patterns are usually built around the data they are matched against, like page
+// buffers pasted into scraper expressions, and are not compiled again
+constexpr size_t MAX_CACHED_PATTERN_SIZE = 64 * 1024;
+}
+
+class CRegExp::CCompiledPattern
+{
+public:
+  CCompiledPattern(pcre* re, pcre_extra* sd, bool jitCompiled)
+    : m_re(re), m_sd(sd), m_jitCompiled(jitCompiled)
+  {
+  }
+
+  ~CCompiledPattern()
+  {
+    if (m_sd)
+      pcre_free_study(m_sd);
+    pcre_free(m_re);
+  }
+
+  CCompiledPattern(const CCompiledPattern&) = delete;
+  CCompiledPattern& operator=(const CCompiledPattern&) = delete;
+
+  pcre* const m_re;
+  pcre_extra* const m_sd;
+  const bool m_jitCompiled;
+};
+
 
 CRegExp::CRegExp(bool caseless /*= false*/, CRegExp::utf8Mode utf8 /*= asciiOnly*/)
 {
@@ -67,7 +104,6 @@ void CRegExp::InitValues(bool caseless /*= false*/, CRegExp::utf8Mode utf8 /*= a
   m_jitCompiled = false;
   m_bMatched    = false;
   m_iMatchCount = 0;
-  m_jitStack    = NULL;
 
   memset(m_iOvector, 0, sizeof(m_iOvector));
 }
@@ -226,7 +262,6 @@ CRegExp::CRegExp(const CRegExp& re)
 {
   m_re = NULL;
   m_sd = NULL;
-  m_jitStack = NULL;
   m_utf8Mode = re.m_utf8Mode;
   m_iOptions = re.m_iOptions;
   *this = re;
@@ -234,28 +269,21 @@ CRegExp::CRegExp(const CRegExp& re)
 
 CRegExp& CRegExp::operator=(const CRegExp& re)
 {
-  size_t size;
+  if (this == &re)
+    return *this;
+
   Cleanup();
-  m_jitCompiled = false;
   m_pattern = re.m_pattern;
-  if (re.m_re)
-  {
-    if (pcre_fullinfo(re.m_re, NULL, PCRE_INFO_SIZE, &size) >= 0)
-    {
-      if ((m_re = (pcre*)malloc(size)))
-      {
-        memcpy(m_re, re.m_re, size);
-        memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
-        m_offset = re.m_offset;
-        m_iMatchCount = re.m_iMatchCount;
-        m_bMatched = re.m_bMatched;
-        m_subject = re.m_subject;
-        m_iOptions = re.m_iOptions;
-      }
-      else
-        CLog::Log(LOGSEVERE, "%s: Failed to allocate memory", __FUNCTION__);
-    }
-  }
+  m_compiled = re.m_compiled;
+  m_re = re.m_re;
+  m_sd = re.m_sd;
+  m_jitCompiled = re.m_jitCompiled;
+  memcpy(m_iOvector, re.m_iOvector, OVECCOUNT*sizeof(int));
+  m_offset = re.m_offset;
+  m_iMatchCount = re.m_iMatchCount;
+  m_bMatched = re.m_bMatched;
+  m_subject = re.m_subject;
+  m_iOptions = re.m_iOptions;
   return *this;
 }
 
@@ -281,40 +309,112 @@ bool CRegExp::RegComp(const char *re, studyMode study /*= NoStudy*/)
 
   Cleanup();
 
-  m_re = pcre_compile(re, options, &errMsg, &errOffset, NULL);
-  if (!m_re)
+  m_compiled = Compile(re, options, study);
+  if (!m_compiled)
   {
     m_pattern.clear();
-    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
-              errMsg, errOffset, re);
     return false;
   }
 
+  m_re = m_compiled->m_re;
+  m_sd = m_compiled->m_sd;
+  m_jitCompiled = m_compiled->m_jitCompiled;
   m_pattern = re;
 
+  return true;
+}
+
+std::shared_ptr<const CRegExp::CCompiledPattern> CRegExp::Compile(const char* re, int options, studyMode study)
+{
+  struct CacheEntry
+  {
+    std::string key;
+    std::shared_ptr<const CCompiledPattern> compiled;
+    size_t size;
+  };
+  // most recently used first
+  typedef std::list<CacheEntry> CacheList;
+  static CCriticalSection cacheSection;
+  static CacheList cacheList;
+  static std::unordered_map<std::string, CacheList::iterator> cache;
+  static size_t cacheSize = 0;
+
+  const size_t length = strlen(re);
+  std::string key;
+  if (length <= MAX_CACHED_PATTERN_SIZE)
+  {
+    key = StringUtils::Format("%d:%d:", options, static_cast<int>(study)) + re;
+    CSingleLock lock(cacheSection);
+    const auto it = cache.find(key);
+    if (it != cache.end())
+    {
+      cacheList.splice(cacheList.begin(), cacheList, it->second);
+      return it->second->compiled;
+    }
+  }
+
+  const char *errMsg = NULL;
+  int errOffset      = 0;
+  pcre* compiledRe = pcre_compile(re, options, &errMsg, &errOffset, NULL);
+  if (!compiledRe)
+  {
+    CLog::Log(LOGERROR, "PCRE: %s. Compilation failed at offset %d in expression '%s'",
+              errMsg, errOffset, re);
+    return nullptr;
+  }
+
+  pcre_extra* studyData = NULL;
+  bool jitCompiled = false;
   if (study)
   {
     const bool jitCompile = (study == StudyWithJitComp) && IsJitSupported();
     const int studyOptions = jitCompile ? PCRE_STUDY_JIT_COMPILE : 0;
 
-    m_sd = pcre_study(m_re, studyOptions, &errMsg);
+    studyData = pcre_study(compiledRe, studyOptions, &errMsg);
     if (errMsg != NULL)
     {
       CLog::Log(LOGWARNING, "%s: PCRE error \"%s\" while studying expression", __FUNCTION__, errMsg);
-      if (m_sd != NULL)
+      if (studyData != NULL)
       {
-        pcre_free_study(m_sd);
-        m_sd = NULL;
+        pcre_free_study(studyData);
+        studyData = NULL;
       }
     }
     else if (jitCompile)
     {
       int jitPresent = 0;
-      m_jitCompiled = (pcre_fullinfo(m_re, m_sd, PCRE_INFO_JIT, &jitPresent) == 0 && jitPresent == 1);
+      jitCompiled = (pcre_fullinfo(compiledRe, studyData, PCRE_INFO_JIT, &jitPresent) == 0 && jitPresent == 1);
     }
   }
 
-  return true;
+  std::shared_ptr<const CCompiledPattern> compiled =
+      std::make_shared<const CCompiledPattern>(compiledRe, studyData, jitCompiled);
+  if (key.empty())
+    return compiled;
+
+  size_t compiledSize = 0;
+  if (pcre_fullinfo(compiledRe, NULL, PCRE_INFO_SIZE, &compiledSize) != 0)
+    compiledSize = 0;
+  const size_t size = key.size() + compiledSize;
+  if (size > MAX_CACHED_PATTERN_SIZE)
+    return compiled;
+
+  CSingleLock lock(cacheSection);
+  // another thread may have compiled the same pattern meanwhile, either result will do
+  if (cache.find(key) != cache.end())
+    return compiled;
+
+  while (!cacheList.empty() && cacheSize + size > MAX_CACHE_SIZE)
+  {
+    cacheSize -= cacheList.back().size;
+    cache.erase(cacheList.back().key);
+    cacheList.pop_back();
+  }
+  cacheList.push_front({key, compiled, size});
+  cache.emplace(key, cacheList.begin());
+  cacheSize += size;
+
+  return compiled;
 }
 
 int CRegExp::RegFind(const char *str, unsigned int startoffset /*= 0*/, int maxNumberOfCharsToTest /*= -1*/)
@@ -346,22 +446,16 @@ int CRegExp::PrivateRegFind(size_t bufferLen, const char *str, unsigned int star
     return -1;
   }
 
-#ifdef PCRE_HAS_JIT_CODE
-  if (m_jitCompiled && !m_jitStack)
-  {
-    m_jitStack = pcre_jit_stack_alloc(32*1024, 512*1024);
-    if (m_jitStack == NULL)
-      CLog::Log(LOGWARNING, "%s: can't allocate address space for JIT stack", __FUNCTION__);
-
-    pcre_assign_jit_stack(m_sd, NULL, m_jitStack);
-  }
-#endif
-
   if (maxNumberOfCharsToTest >= 0)
     bufferLen = std::min<size_t>(bufferLen, startoffset + maxNumberOfCharsToTest);
 
   m_subject.assign(str + startoffset, bufferLen - startoffset);
-  int rc = pcre_exec(m_re, NULL, m_subject.c_str(), m_subject.length(), 0, 0, m_iOvector, OVECCOUNT);
+  int rc = pcre_exec(m_re, m_sd, m_subject.c_str(), m_subject.length(), 0, 0, m_iOvector, OVECCOUNT);
+#ifdef PCRE_ERROR_JIT_STACKLIMIT
+  // shared JIT code runs on the default machine stack, let the interpreter handle deep recursion
+  if (rc == PCRE_ERROR_JIT_STACKLIMIT)
+    rc = pcre_exec(m_re, NULL, m_subject.c_str(), m_subject.length(), 0, 0, m_iOvector, OVECCOUNT);
+#endif
 
   if (rc<1)
   {
@@ -547,25 +641,9 @@ void CRegExp::DumpOvector(int iLog /* = LOGDEBUG */)
 
 void CRegExp::Cleanup()
 {
-  if (m_re)
-  {
-    pcre_free(m_re);
-    m_re = NULL;
-  }
-
-  if (m_sd)
-  {
-    pcre_free_study(m_sd);
-    m_sd = NULL;
-  }
-
-#ifdef PCRE_HAS_JIT_CODE
-  if (m_jitStack)
-  {
-    pcre_jit_stack_free(m_jitStack);
-    m_jitStack = NULL;
-  }
-#endif
+  m_compiled.reset();
+  m_re = NULL;
+  m_sd = NULL;
 }
 
 inline bool CRegExp::IsValidSubNumber(int iSub) const
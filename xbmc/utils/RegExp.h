@@ -10,6 +10,7 @@
 
 //! @todo - move to std::regex (after switching to gcc 4.9 or higher) and get rid of CRegExp
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -134,6 +135,16 @@ public:
   static bool IsJitSupported(void);
 
 private:
+  friend class CRegExpSet;
+  class CCompiledPattern;
+
+  /*!
+   * Compiled patterns are shared process-wide by pattern, options and study mode, so
+   * expressions compiled over and over (scanner, scrapers, filename cleaning) are only
+   * compiled once. The cache is limited by size and drops the least recently used patterns;
+   * very large ones, e.g. built around page buffers, are compiled per call.
+   */
+  static std::shared_ptr<const CCompiledPattern> Compile(const char* re, int options, studyMode study);
   int PrivateRegFind(size_t bufferLen, const char *str, unsigned int startoffset = 0, int maxNumberOfCharsToTest = -1);
   void InitValues(bool caseless = false, CRegExp::utf8Mode utf8 = asciiOnly);
   static bool requireUtf8(const std::string& regexp);
@@ -143,6 +154,7 @@ private:
   void Cleanup();
   inline bool IsValidSubNumber(int iSub) const;
 
+  std::shared_ptr<const CCompiledPattern> m_compiled;
   PCRE::pcre* m_re;
   PCRE::pcre_extra* m_sd;
   static const int OVECCOUNT=(m_MaxNumOfBackrefrences + 1) * 3;
@@ -153,7 +165,6 @@ private:
   int         m_iOptions;
   bool        m_jitCompiled;
   bool        m_bMatched;
-  PCRE::pcre_jit_stack* m_jitStack;
   std::string m_subject;
   std::string m_pattern;
   static int  m_Utf8Supported;
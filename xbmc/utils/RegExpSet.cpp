@@ -0,0 +1,165 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "RegExpSet.h"
+
+#include "log.h"
+
+#include <algorithm>
+
+using namespace PCRE;
+
+namespace
+{
+inline void SetByte(unsigned char* bitmap, unsigned char c)
+{
+  bitmap[c / 8] |= 1 << (c % 8);
+}
+
+inline bool HasByte(const unsigned char* bitmap, unsigned char c)
+{
+  return (bitmap[c / 8] & (1 << (c % 8))) != 0;
+}
+}
+
+CRegExpSet::CRegExpSet(bool caseless /* = false */, CRegExp::utf8Mode utf8 /* = CRegExp::asciiOnly */)
+  : m_caseless(caseless), m_utf8Mode(utf8)
+{
+}
+
+bool CRegExpSet::Compile(const std::vector<std::string>& patterns, CRegExp::studyMode study /* = CRegExp::StudyWithJitComp */)
+{
+  bool ret = true;
+
+  m_patterns.clear();
+  m_patterns.reserve(patterns.size());
+  for (const auto& pattern : patterns)
+  {
+    m_patterns.emplace_back();
+    Pattern& entry = m_patterns.back();
+    entry.regexp = CRegExp(m_caseless, m_utf8Mode);
+    entry.pattern = pattern;
+
+    if (!entry.regexp.RegComp(pattern, study))
+    {
+      CLog::Log(LOGERROR, "%s: Invalid RegExp:'%s'", __FUNCTION__, pattern.c_str());
+      ret = false;
+      continue;
+    }
+    entry.valid = true;
+
+    // collect the hints PCRE uses to reject subjects early, so a whole pattern run can be
+    // skipped. Every hint is optional, a pattern without any of them is always run.
+    const pcre* re = entry.regexp.m_re;
+    const pcre_extra* sd = entry.regexp.m_sd;
+
+    int minLength = -1;
+    if (pcre_fullinfo(re, sd, PCRE_INFO_MINLENGTH, &minLength) == 0 && minLength > 0)
+      entry.minLength = minLength;
+
+    // with UTF-8 and caseless matching the other case of a non-ASCII byte is unknown here
+    int lastLiteral = -1;
+    if (pcre_fullinfo(re, sd, PCRE_INFO_LASTLITERAL, &lastLiteral) == 0 &&
+        lastLiteral >= 0 && lastLiteral < 0x80)
+      entry.requiredByte = lastLiteral;
+
+    // the first byte table is only valid if the pattern can't match an empty string
+    const unsigned char* firstTable = nullptr;
+    if (entry.minLength > 0 &&
+        pcre_fullinfo(re, sd, PCRE_INFO_FIRSTTABLE, &firstTable) == 0 && firstTable)
+    {
+      std::copy(firstTable, firstTable + sizeof(entry.startBytes), entry.startBytes);
+      entry.hasStartBytes = true;
+    }
+  }
+
+  return ret;
+}
+
+bool CRegExpSet::CanMatch(const Pattern& pattern, const unsigned char* presentBytes, size_t length) const
+{
+  if (static_cast<size_t>(pattern.minLength) > length)
+    return false;
+
+  if (pattern.requiredByte >= 0 && !HasByte(presentBytes, pattern.requiredByte))
+    return false;
+
+  if (pattern.hasStartBytes)
+  {
+    for (size_t i = 0; i < sizeof(pattern.startBytes); ++i)
+    {
+      if (pattern.startBytes[i] & presentBytes[i])
+        return true;
+    }
+    return false;
+  }
+
+  return true;
+}
+
+int CRegExpSet::FindFirst(const std::string& subject, size_t firstPattern /* = 0 */)
+{
+  // one pass over the subject to know which bytes it contains. ASCII letters are recorded in both
+  // cases, which keeps the test valid for caseless patterns.
+  unsigned char presentBytes[32] = {};
+  for (const char ch : subject)
+  {
+    const unsigned char c = static_cast<unsigned char>(ch);
+    SetByte(presentBytes, c);
+    if (c >= 'a' && c <= 'z')
+      SetByte(presentBytes, c - ('a' - 'A'));
+    else if (c >= 'A' && c <= 'Z')
+      SetByte(presentBytes, c + ('a' - 'A'));
+  }
+
+  for (size_t i = firstPattern; i < m_patterns.size(); ++i)
+  {
+    Pattern& pattern = m_patterns[i];
+    if (!pattern.valid)
+      continue;
+
+    if (!CanMatch(pattern, presentBytes, subject.length()))
+    {
+      pattern.skips++;
+      continue;
+    }
+
+    pattern.runs++;
+    if (pattern.regexp.RegFind(subject) >= 0)
+    {
+      pattern.hits++;
+      return static_cast<int>(i);
+    }
+  }
+
+  return -1;
+}
+
+void CRegExpSet::ResetStatistics()
+{
+  for (auto& pattern : m_patterns)
+  {
+    pattern.hits = 0;
+    pattern.runs = 0;
+    pattern.skips = 0;
+  }
+}
+
+void CRegExpSet::LogStatistics(const std::string& name) const
+{
+  for (size_t i = 0; i < m_patterns.size(); ++i)
+  {
+    const Pattern& pattern = m_patterns[i];
+    if (!pattern.valid)
+      continue;
+
+    CLog::Log(LOGDEBUG, "%s: pattern %u '%s' matched %u times (%u runs, %u skipped)",
+              name.c_str(), static_cast<unsigned int>(i), pattern.pattern.c_str(),
+              pattern.hits, pattern.runs, pattern.skips);
+  }
+}
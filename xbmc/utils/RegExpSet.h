@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include "utils/RegExp.h"
+
+#include <string>
+#include <vector>
+
+/*!
+ * \brief Ordered list of regular expressions matched against the same subject.
+ *
+ * All patterns are compiled once and tried in list order, so the first matching pattern wins
+ * just like a loop over CRegExp objects. The subject is scanned once per lookup to collect the
+ * bytes it contains, and patterns that cannot match it (a required byte or every possible first
+ * byte is missing, or the subject is shorter than any match) are skipped without running PCRE.
+ * Per pattern statistics are kept to help tuning pattern lists in advancedsettings.xml.
+ */
+class CRegExpSet
+{
+public:
+  /*!
+   * \param caseless Matching will be case insensitive if set to true
+   * \param utf8 Control UTF-8 processing of the patterns
+   */
+  explicit CRegExpSet(bool caseless = false, CRegExp::utf8Mode utf8 = CRegExp::asciiOnly);
+
+  /*!
+   * \brief Compile a list of patterns, replacing the current ones and resetting statistics.
+   * Invalid patterns are logged and never match, indexes always refer to \p patterns.
+   * \return true if all patterns were compiled, false otherwise
+   */
+  bool Compile(const std::vector<std::string>& patterns,
+               CRegExp::studyMode study = CRegExp::StudyWithJitComp);
+
+  /*!
+   * \brief Find the first pattern matching the subject.
+   * \param subject The string to match against the patterns
+   * \param firstPattern (optional) Index of the first pattern to try, used to resume a lookup
+   *                                after a match was rejected by the caller
+   * \return index of the matching pattern, -1 if none matched. The match itself is available
+   *         through GetRegExp(index).
+   */
+  int FindFirst(const std::string& subject, size_t firstPattern = 0);
+
+  CRegExp& GetRegExp(size_t index) { return m_patterns[index].regexp; }
+  const std::string& GetPattern(size_t index) const { return m_patterns[index].pattern; }
+  size_t Size() const { return m_patterns.size(); }
+  bool IsEmpty() const { return m_patterns.empty(); }
+
+  /*!
+   * \brief Number of subjects matched by the pattern at \p index.
+   */
+  unsigned int GetHits(size_t index) const { return m_patterns[index].hits; }
+
+  void ResetStatistics();
+  /*!
+   * \brief Log hits, PCRE runs and prefilter skips of each pattern at debug level.
+   * \param name Name of the pattern list for the log
+   */
+  void LogStatistics(const std::string& name) const;
+
+private:
+  struct Pattern
+  {
+    CRegExp regexp;
+    std::string pattern;
+    bool valid = false;
+    int minLength = 0; // minimum match length in characters
+    int requiredByte = -1; // an ASCII byte every match contains, -1 if unknown
+    bool hasStartBytes = false;
+    unsigned char startBytes[32] = {}; // bitmap of bytes a match can start with
+    unsigned int hits = 0;
+    unsigned int runs = 0;
+    unsigned int skips = 0;
+  };
+
+  bool CanMatch(const Pattern& pattern, const unsigned char* presentBytes, size_t length) const;
+
+  bool m_caseless;
+  CRegExp::utf8Mode m_utf8Mode;
+  std::vector<Pattern> m_patterns;
+};
@@ -16,6 +16,9 @@
 #include "utils/Variant.h"
 
 #include <algorithm>
+#include <locale>
+#include <stdint.h>
+#include <unordered_map>
 
 std::string ArrayToString(SortAttribute attributes, const CVariant &variant, const std::string &separator = " / ")
 {
@@ -433,130 +436,187 @@ std::string ByLastUsed(SortAttribute attributes, const SortItem &values)
   return values.at(FieldLastUsed).asString();
 }
 
-bool preliminarySort(const SortItem &left, const SortItem &right, bool handleFolder, bool &result, std::wstring &labelLeft, std::wstring &labelRight)
+/*!
+ \brief Builds binary sort keys which, compared bytewise, order labels the same way
+ StringUtils::AlphaNumericCompare() does.
+
+ Every distinct character of the labels is ranked once with the collate facet of the system
+ locale, so the expensive locale aware comparison is done per character instead of per
+ comparison. A label is then encoded as a sequence of big-endian tokens:
+  - a character is encoded as its rank (4 bytes)
+  - a run of up to 15 digits is encoded as a marker ranked just below '0' (4 bytes) followed by
+    its numerical value (8 bytes)
+ */
+class CCollationKeyBuilder
 {
-  // make sure both items have the necessary data to do the sorting
-  SortItem::const_iterator itLeftSort, itRightSort;
-  if ((itLeftSort = left.find(FieldSort)) == left.end())
-  {
-    result = false;
-    return true;
-  }
-  if ((itRightSort = right.find(FieldSort)) == right.end())
+public:
+  explicit CCollationKeyBuilder(const std::vector<std::wstring> &labels)
   {
-    result = true;
-    return true;
+    std::vector<wchar_t> chars;
+    chars.push_back(L'0');
+    for (const auto &label : labels)
+    {
+      for (wchar_t c : label)
+        chars.push_back(Lower(c));
+    }
+    std::sort(chars.begin(), chars.end());
+    chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+
+    const std::collate<wchar_t>& coll = std::use_facet<std::collate<wchar_t> >(g_langInfo.GetSystemLocale());
+    auto less = [&coll](wchar_t left, wchar_t right)
+    {
+      return coll.compare(&left, &left + 1, &right, &right + 1) < 0;
+    };
+    std::stable_sort(chars.begin(), chars.end(), less);
+
+    uint32_t rank = 0;
+    for (size_t i = 0; i < chars.size(); ++i)
+    {
+      if (i > 0 && less(chars[i - 1], chars[i]))
+        rank++;
+      m_ranks.insert(std::make_pair(chars[i], 2 + 2 * rank));
+    }
+    m_numberMarker = m_ranks[L'0'] - 1;
   }
 
-  // look at special sorting behaviour
-  SortItem::const_iterator itLeft, itRight;
-  SortSpecial leftSortSpecial = SortSpecialNone;
-  SortSpecial rightSortSpecial = SortSpecialNone;
-  if ((itLeft = left.find(FieldSortSpecial)) != left.end() && itLeft->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    leftSortSpecial = (SortSpecial)itLeft->second.asInteger();
-  if ((itRight = right.find(FieldSortSpecial)) != right.end() && itRight->second.asInteger() <= (int64_t)SortSpecialOnBottom)
-    rightSortSpecial = (SortSpecial)itRight->second.asInteger();
-
-  // one has a special sort
-  if (leftSortSpecial != rightSortSpecial)
+  std::string GetKey(const std::wstring &label) const
   {
-    // left should be sorted on top
-    // or right should be sorted on bottom
-    // => left is sorted above right
-    if (leftSortSpecial == SortSpecialOnTop ||
-        rightSortSpecial == SortSpecialOnBottom)
+    std::string key;
+    key.reserve(label.size() * 4);
+
+    const wchar_t *c = label.c_str();
+    while (*c != 0)
     {
-      result = true;
-      return true;
+      if (*c >= L'0' && *c <= L'9')
+      {
+        // compare only up to 15 digits, just like AlphaNumericCompare()
+        const wchar_t *start = c;
+        uint64_t number = 0;
+        while (*c >= L'0' && *c <= L'9' && c < start + 15)
+          number = number * 10 + (*c++ - L'0');
+
+        Append(key, m_numberMarker, 4);
+        Append(key, number, 8);
+        continue;
+      }
+
+      Append(key, m_ranks.at(Lower(*c)), 4);
+      c++;
     }
 
-    // otherwise right is sorted above left
-    result = false;
-    return true;
+    return key;
   }
-  // both have either sort on top or sort on bottom -> leave as-is
-  else if (leftSortSpecial != SortSpecialNone && leftSortSpecial == rightSortSpecial)
+
+private:
+  static wchar_t Lower(wchar_t c)
   {
-    result = false;
-    return true;
+    if (c >= L'A' && c <= L'Z')
+      c += L'a' - L'A';
+    return c;
   }
 
-  if (handleFolder)
+  static void Append(std::string &key, uint64_t value, int bytes)
   {
-    itLeft = left.find(FieldFolder);
-    itRight = right.find(FieldFolder);
-    if (itLeft != left.end() && itRight != right.end() &&
-        itLeft->second.asBoolean() != itRight->second.asBoolean())
-    {
-      result = itLeft->second.asBoolean();
-      return true;
-    }
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+      key.push_back(static_cast<char>((value >> shift) & 0xFF));
   }
 
-  labelLeft = itLeftSort->second.asWideString();
-  labelRight = itRightSort->second.asWideString();
+  std::unordered_map<wchar_t, uint32_t> m_ranks;
+  uint32_t m_numberMarker;
+};
 
-  return false;
-}
+struct SortEntry
+{
+  std::string key;
+  int special;  // 0 = sort on top, 1 = no special handling, 2 = sort on bottom
+  int folder;   // -1 = unknown, 0 = folder, 1 = no folder
+  size_t index; // original position, used to keep the sort stable
+};
 
-bool SorterAscending(const SortItem &left, const SortItem &right)
+class CSortEntryComparator
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+public:
+  CSortEntryComparator(SortOrder sortOrder, SortAttribute attributes)
+    : m_descending(sortOrder == SortOrderDescending),
+      m_handleFolder((attributes & SortAttributeIgnoreFolders) == 0)
+  { }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+  bool operator()(const SortEntry &left, const SortEntry &right) const
+  {
+    // items sorted on top or on bottom keep their order
+    if (left.special != right.special)
+      return left.special < right.special;
+    if (left.special != 1)
+      return left.index < right.index;
 
-bool SorterDescending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, true, result, labelLeft, labelRight))
-    return result;
+    if (m_handleFolder && left.folder >= 0 && right.folder >= 0 && left.folder != right.folder)
+      return left.folder < right.folder;
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+    int result = left.key.compare(right.key);
+    if (result != 0)
+      return m_descending ? result > 0 : result < 0;
 
-bool SorterIgnoreFoldersAscending(const SortItem &left, const SortItem &right)
-{
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+    return left.index < right.index;
+  }
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) < 0;
-}
+private:
+  bool m_descending;
+  bool m_handleFolder;
+};
 
-bool SorterIgnoreFoldersDescending(const SortItem &left, const SortItem &right)
+/*!
+ \brief Determines the order of the given (prepared) items.
+ \return the indices of the items in sorted order, only the first limitEnd of them are guaranteed
+ to be sorted if limitEnd is positive.
+ */
+std::vector<size_t> GetSortOrder(const std::vector<const SortItem*> &items, SortOrder sortOrder, SortAttribute attributes, int limitEnd)
 {
-  bool result;
-  std::wstring labelLeft, labelRight;
-  if (preliminarySort(left, right, false, result, labelLeft, labelRight))
-    return result;
+  std::vector<std::wstring> labels;
+  labels.reserve(items.size());
+  for (const SortItem *item : items)
+    labels.push_back(item->at(FieldSort).asWideString());
 
-  return StringUtils::AlphaNumericCompare(labelLeft.c_str(), labelRight.c_str()) > 0;
-}
+  CCollationKeyBuilder keyBuilder(labels);
 
-bool SorterIndirectAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterAscending(*left, *right);
-}
+  std::vector<SortEntry> entries(items.size());
+  for (size_t i = 0; i < items.size(); ++i)
+  {
+    SortEntry &entry = entries[i];
+    entry.key = keyBuilder.GetKey(labels[i]);
+    entry.index = i;
 
-bool SorterIndirectDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterDescending(*left, *right);
-}
+    entry.special = 1;
+    SortItem::const_iterator it = items[i]->find(FieldSortSpecial);
+    if (it != items[i]->end())
+    {
+      int64_t special = it->second.asInteger();
+      if (special == SortSpecialOnTop)
+        entry.special = 0;
+      else if (special == SortSpecialOnBottom)
+        entry.special = 2;
+    }
 
-bool SorterIndirectIgnoreFoldersAscending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersAscending(*left, *right);
-}
+    entry.folder = -1;
+    it = items[i]->find(FieldFolder);
+    if (it != items[i]->end())
+      entry.folder = it->second.asBoolean() ? 0 : 1;
+  }
+  labels.clear();
 
-bool SorterIndirectIgnoreFoldersDescending(const SortItemPtr &left, const SortItemPtr &right)
-{
-  return SorterIgnoreFoldersDescending(*left, *right);
+  // the index makes the order total so there's no need for a stable sort, which also allows
+  // to only sort the requested part of the items
+  CSortEntryComparator comparator(sortOrder, attributes);
+  if (limitEnd > 0 && (size_t)limitEnd < entries.size())
+    std::partial_sort(entries.begin(), entries.begin() + limitEnd, entries.end(), comparator);
+  else
+    std::sort(entries.begin(), entries.end(), comparator);
+
+  std::vector<size_t> order;
+  order.reserve(entries.size());
+  for (const auto &entry : entries)
+    order.push_back(entry.index);
+
+  return order;
 }
 
 std::map<SortBy, SortUtils::SortPreparator> fillPreparators()
@@ -738,8 +798,22 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
         item->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorter(sortOrder, attributes));
+      // Do the sorting, items behind limitEnd are removed anyway
+      std::vector<const SortItem*> sortItems;
+      sortItems.reserve(items.size());
+      for (const auto &item : items)
+        sortItems.push_back(&item);
+      std::vector<size_t> order = GetSortOrder(sortItems, sortOrder, attributes, limitEnd);
+      sortItems.clear();
+
+      if (limitEnd > 0 && (size_t)limitEnd < order.size())
+        order.resize(limitEnd);
+
+      DatabaseResults sortedItems;
+      sortedItems.reserve(order.size());
+      for (size_t index : order)
+        sortedItems.push_back(std::move(items[index]));
+      items = std::move(sortedItems);
     }
   }
 
@@ -777,8 +851,22 @@ void SortUtils::Sort(SortBy sortBy, SortOrder sortOrder, SortAttribute attribute
         (*item)->insert(std::pair<Field, CVariant>(FieldSort, CVariant(sortLabel)));
       }
 
-      // Do the sorting
-      std::stable_sort(items.begin(), items.end(), getSorterIndirect(sortOrder, attributes));
+      // Do the sorting, items behind limitEnd are removed anyway
+      std::vector<const SortItem*> sortItems;
+      sortItems.reserve(items.size());
+      for (const auto &item : items)
+        sortItems.push_back(item.get());
+      std::vector<size_t> order = GetSortOrder(sortItems, sortOrder, attributes, limitEnd);
+      sortItems.clear();
+
+      if (limitEnd > 0 && (size_t)limitEnd < order.size())
+        order.resize(limitEnd);
+
+      SortItems sortedItems;
+      sortedItems.reserve(order.size());
+      for (size_t index : order)
+        sortedItems.push_back(std::move(items[index]));
+      items = std::move(sortedItems);
     }
   }
 
@@ -831,22 +919,6 @@ const SortUtils::SortPreparator& SortUtils::getPreparator(SortBy sortBy)
   return m_preparators[SortByNone];
 }
 
-SortUtils::Sorter SortUtils::getSorter(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIgnoreFoldersDescending : SorterIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterDescending : SorterAscending;
-}
-
-SortUtils::SorterIndirect SortUtils::getSorterIndirect(SortOrder sortOrder, SortAttribute attributes)
-{
-  if (attributes & SortAttributeIgnoreFolders)
-    return sortOrder == SortOrderDescending ? SorterIndirectIgnoreFoldersDescending : SorterIndirectIgnoreFoldersAscending;
-
-  return sortOrder == SortOrderDescending ? SorterIndirectDescending : SorterIndirectAscending;
-}
-
 const Fields& SortUtils::GetFieldsForSorting(SortBy sortBy)
 {
   std::map<SortBy, Fields>::const_iterator it = m_sortingFields.find(sortBy);
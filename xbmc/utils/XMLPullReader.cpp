@@ -0,0 +1,527 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "XMLPullReader.h"
+
+#include "URL.h"
+#include "PlatformDefs.h" //for strcasecmp
+#include "utils/CharsetConverter.h"
+#include "utils/CharsetDetection.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace
+{
+inline bool IsWhiteSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline bool IsNameStart(char c)
+{
+  // same test as TinyXML uses to tell elements from unknown markup
+  return isalpha(static_cast<unsigned char>(c)) || c == '_' || (c & 0x80);
+}
+
+inline bool IsNameEnd(char c)
+{
+  return IsWhiteSpace(c) || c == '/' || c == '>' || c == '=';
+}
+
+void AppendUtf8(std::string& str, unsigned long code)
+{
+  if (code < 0x80)
+    str += static_cast<char>(code);
+  else if (code < 0x800)
+  {
+    str += static_cast<char>(0xC0 | (code >> 6));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  }
+  else if (code < 0x10000)
+  {
+    str += static_cast<char>(0xE0 | (code >> 12));
+    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  }
+  else if (code < 0x110000)
+  {
+    str += static_cast<char>(0xF0 | (code >> 18));
+    str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    str += static_cast<char>(0x80 | (code & 0x3F));
+  }
+}
+
+// decode the predefined and numeric entities, unknown ones are kept as they are
+void DecodeEntities(const char* data, size_t length, std::string& result)
+{
+  static const struct
+  {
+    const char* entity;
+    size_t length;
+    char value;
+  } entities[] = {
+    { "&amp;", 5, '&' },
+    { "&lt;", 4, '<' },
+    { "&gt;", 4, '>' },
+    { "&quot;", 6, '\"' },
+    { "&apos;", 6, '\'' },
+  };
+
+  result.clear();
+  result.reserve(length);
+
+  const char* end = data + length;
+  const char* p = data;
+  while (p < end)
+  {
+    const char* amp = static_cast<const char*>(memchr(p, '&', end - p));
+    if (!amp)
+    {
+      result.append(p, end - p);
+      break;
+    }
+    result.append(p, amp - p);
+    p = amp;
+
+    bool decoded = false;
+    if (p + 2 < end && p[1] == '#')
+    {
+      const char* semicolon = static_cast<const char*>(memchr(p, ';', end - p));
+      if (semicolon)
+      {
+        const bool hex = p[2] == 'x' || p[2] == 'X';
+        char* numberEnd = nullptr;
+        const unsigned long code = strtoul(p + (hex ? 3 : 2), &numberEnd, hex ? 16 : 10);
+        if (numberEnd == semicolon && code > 0)
+        {
+          AppendUtf8(result, code);
+          p = semicolon + 1;
+          decoded = true;
+        }
+      }
+    }
+    else
+    {
+      for (const auto& entity : entities)
+      {
+        if (static_cast<size_t>(end - p) >= entity.length &&
+            strncmp(p, entity.entity, entity.length) == 0)
+        {
+          result += entity.value;
+          p += entity.length;
+          decoded = true;
+          break;
+        }
+      }
+    }
+
+    if (!decoded)
+      result += *p++;
+  }
+}
+}
+
+CXMLPullReader::CXMLPullReader(const char* data, size_t length)
+  : m_data(data), m_length(data ? length : 0)
+{
+  // skip a UTF-8 byte order mark
+  if (m_length >= 3 && strncmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+    m_pos = 3;
+}
+
+CXMLPullReader::CXMLPullReader(const std::string& data)
+  : CXMLPullReader(data.c_str(), data.size())
+{
+}
+
+bool CXMLPullReader::StartsWith(const char* str) const
+{
+  const size_t length = strlen(str);
+  return m_length - m_pos >= length && strncmp(m_data + m_pos, str, length) == 0;
+}
+
+bool CXMLPullReader::SkipPast(const char* terminator)
+{
+  const char* end = m_data + m_length;
+  const char* found = std::search(m_data + m_pos, end, terminator, terminator + strlen(terminator));
+  if (found == end)
+    return false;
+
+  m_pos = found - m_data + strlen(terminator);
+  return true;
+}
+
+bool CXMLPullReader::ParseStartTag()
+{
+  size_t pos = m_pos + 1;
+  m_nameStart = pos;
+  while (pos < m_length && !IsNameEnd(m_data[pos]))
+    pos++;
+  m_nameLength = pos - m_nameStart;
+
+  // find the end of the tag, '>' may appear in attribute values
+  char quote = 0;
+  for (; pos < m_length; pos++)
+  {
+    const char c = m_data[pos];
+    if (quote)
+    {
+      if (c == quote)
+        quote = 0;
+    }
+    else if (c == '\"' || c == '\'')
+      quote = c;
+    else if (c == '>')
+      break;
+  }
+  if (pos >= m_length)
+    return false;
+
+  m_empty = m_data[pos - 1] == '/';
+  m_pos = pos + 1;
+  m_token = TOKEN_START_ELEMENT;
+  m_depth = m_openElements;
+  if (!m_empty)
+    m_openElements++;
+  return true;
+}
+
+bool CXMLPullReader::ParseEndTag()
+{
+  m_nameStart = m_pos + 2;
+  size_t pos = m_nameStart;
+  while (pos < m_length && !IsNameEnd(m_data[pos]))
+    pos++;
+  m_nameLength = pos - m_nameStart;
+
+  const char* gt = static_cast<const char*>(memchr(m_data + pos, '>', m_length - pos));
+  if (!gt)
+    return false;
+
+  m_pos = gt - m_data + 1;
+  m_token = TOKEN_END_ELEMENT;
+  if (m_openElements > 0)
+    m_openElements--;
+  m_depth = m_openElements;
+  return true;
+}
+
+CXMLPullReader::Token CXMLPullReader::Next()
+{
+  if (m_error)
+    return m_token;
+
+  while (m_pos < m_length)
+  {
+    m_tokenStart = m_pos;
+    m_empty = false;
+    m_cdata = false;
+
+    if (m_data[m_pos] != '<')
+    {
+      const char* lt = static_cast<const char*>(memchr(m_data + m_pos, '<', m_length - m_pos));
+      const size_t end = lt ? lt - m_data : m_length;
+      m_textStart = m_pos;
+      m_textLength = end - m_pos;
+      m_pos = end;
+      m_token = TOKEN_TEXT;
+      m_depth = m_openElements;
+      return m_token;
+    }
+
+    bool ok = true;
+    if (StartsWith("<!--"))
+      ok = SkipPast("-->");
+    else if (StartsWith("<![CDATA["))
+    {
+      m_textStart = m_pos + 9;
+      ok = SkipPast("]]>");
+      if (ok)
+      {
+        m_textLength = m_pos - 3 - m_textStart;
+        m_cdata = true;
+        m_token = TOKEN_TEXT;
+        m_depth = m_openElements;
+        return m_token;
+      }
+    }
+    else if (StartsWith("<?"))
+      ok = SkipPast("?>");
+    else if (StartsWith("</"))
+    {
+      if (ParseEndTag())
+        return m_token;
+      ok = false;
+    }
+    else if (m_pos + 1 < m_length && IsNameStart(m_data[m_pos + 1]))
+    {
+      if (ParseStartTag())
+        return m_token;
+      ok = false;
+    }
+    else
+      ok = SkipPast(">"); // DOCTYPE and unknown markup
+
+    if (!ok)
+    {
+      m_error = true;
+      m_token = TOKEN_ERROR;
+      return m_token;
+    }
+  }
+
+  m_tokenStart = m_pos;
+  m_token = TOKEN_END_OF_DOCUMENT;
+  return m_token;
+}
+
+bool CXMLPullReader::NextElement(const char* name)
+{
+  for (;;)
+  {
+    switch (Next())
+    {
+    case TOKEN_START_ELEMENT:
+      if (IsName(name))
+        return true;
+      break;
+    case TOKEN_END_OF_DOCUMENT:
+    case TOKEN_ERROR:
+      return false;
+    default:
+      break;
+    }
+  }
+}
+
+bool CXMLPullReader::SkipElement()
+{
+  if (m_token != TOKEN_START_ELEMENT)
+    return false;
+  if (m_empty)
+    return true;
+
+  const int depth = m_depth;
+  for (;;)
+  {
+    switch (Next())
+    {
+    case TOKEN_END_ELEMENT:
+      if (m_depth == depth)
+        return true;
+      break;
+    case TOKEN_END_OF_DOCUMENT:
+    case TOKEN_ERROR:
+      return false;
+    default:
+      break;
+    }
+  }
+}
+
+bool CXMLPullReader::IsName(const char* name) const
+{
+  if (m_token != TOKEN_START_ELEMENT && m_token != TOKEN_END_ELEMENT)
+    return false;
+
+  return strlen(name) == m_nameLength && strncmp(m_data + m_nameStart, name, m_nameLength) == 0;
+}
+
+std::string CXMLPullReader::GetName() const
+{
+  if (m_token != TOKEN_START_ELEMENT && m_token != TOKEN_END_ELEMENT)
+    return std::string();
+
+  return std::string(m_data + m_nameStart, m_nameLength);
+}
+
+std::string CXMLPullReader::GetText() const
+{
+  std::string text;
+  if (m_token != TOKEN_TEXT)
+    return text;
+
+  if (m_cdata)
+    text.assign(m_data + m_textStart, m_textLength);
+  else
+    DecodeEntities(m_data + m_textStart, m_textLength, text);
+  return text;
+}
+
+bool CXMLPullReader::GetAttribute(const char* name, std::string& value) const
+{
+  if (m_token != TOKEN_START_ELEMENT)
+    return false;
+
+  const size_t nameLength = strlen(name);
+  size_t pos = m_nameStart + m_nameLength;
+  const size_t end = m_pos - 1;
+  while (pos < end)
+  {
+    while (pos < end && (IsWhiteSpace(m_data[pos]) || m_data[pos] == '/'))
+      pos++;
+
+    const size_t attrStart = pos;
+    while (pos < end && !IsNameEnd(m_data[pos]))
+      pos++;
+    const size_t attrLength = pos - attrStart;
+
+    while (pos < end && IsWhiteSpace(m_data[pos]))
+      pos++;
+    if (pos >= end || m_data[pos] != '=')
+      return false;
+    pos++;
+    while (pos < end && IsWhiteSpace(m_data[pos]))
+      pos++;
+    if (pos >= end || (m_data[pos] != '\"' && m_data[pos] != '\''))
+      return false;
+
+    const char quote = m_data[pos++];
+    const size_t valueStart = pos;
+    while (pos < end && m_data[pos] != quote)
+      pos++;
+    if (pos >= end)
+      return false;
+
+    if (attrLength == nameLength && strncmp(m_data + attrStart, name, nameLength) == 0)
+    {
+      DecodeEntities(m_data + valueStart, pos - valueStart, value);
+      return true;
+    }
+    pos++;
+  }
+  return false;
+}
+
+bool CXMLPullReader::IsBlankText() const
+{
+  if (m_token != TOKEN_TEXT || m_cdata)
+    return false;
+
+  const char* text = m_data + m_textStart;
+  return std::find_if(text, text + m_textLength, [](char c) { return !IsWhiteSpace(c); }) ==
+         text + m_textLength;
+}
+
+// returns -1 if there's no such child, 0 if the child has no text and 1 if value was set
+int CXMLPullReader::FindChild(const char* tag, std::string& value) const
+{
+  if (m_token != TOKEN_START_ELEMENT || m_empty)
+    return -1;
+
+  CXMLPullReader reader(*this);
+  const int childDepth = m_depth + 1;
+  for (;;)
+  {
+    switch (reader.Next())
+    {
+    case TOKEN_START_ELEMENT:
+      if (!reader.IsName(tag))
+      {
+        if (!reader.SkipElement())
+          return -1;
+      }
+      else
+      {
+        if (reader.IsEmptyElement())
+          return 0;
+
+        std::string encoded;
+        const bool urlEncoded = reader.GetAttribute("urlencoded", encoded) &&
+                                strcasecmp(encoded.c_str(), "yes") == 0;
+
+        // whitespace only text isn't a node in CXBMCTinyXML
+        while (reader.Next() == TOKEN_TEXT && reader.IsBlankText())
+          ;
+        if (reader.GetToken() == TOKEN_TEXT)
+          value = reader.GetText();
+        else if (reader.GetToken() == TOKEN_START_ELEMENT)
+          value = reader.GetName();
+        else
+          return 0;
+
+        if (urlEncoded)
+          value = CURL::Decode(value);
+        return 1;
+      }
+      break;
+    case TOKEN_END_ELEMENT:
+      if (reader.GetDepth() < childDepth)
+        return -1;
+      break;
+    case TOKEN_END_OF_DOCUMENT:
+    case TOKEN_ERROR:
+      return -1;
+    default:
+      break;
+    }
+  }
+}
+
+bool CXMLPullReader::GetString(const char* tag, std::string& value) const
+{
+  const int found = FindChild(tag, value);
+  if (found < 0)
+    return false;
+
+  if (found == 0)
+    value.clear();
+  return true;
+}
+
+bool CXMLPullReader::GetInt(const char* tag, int& value) const
+{
+  std::string text;
+  if (FindChild(tag, text) <= 0)
+    return false;
+
+  value = atoi(text.c_str());
+  return true;
+}
+
+bool CXMLPullReader::ConvertToUtf8(std::string& document)
+{
+  std::string charset;
+  if (!CCharsetDetection::DetectXmlEncoding(document, charset) || charset == "UTF-8")
+    return true;
+
+  // ASCII compatible if markup comes out the same
+  std::string markup;
+  if (g_charsetConverter.utf8To(charset, "<", markup) && markup == "<")
+    return true;
+
+  std::string converted;
+  if (!g_charsetConverter.ToUtf8(charset, document, converted) || converted.empty())
+    return false;
+
+  document.swap(converted);
+  return true;
+}
+
+bool CXMLPullReader::ReadRootElement()
+{
+  for (;;)
+  {
+    switch (Next())
+    {
+    case TOKEN_START_ELEMENT:
+      return true;
+    case TOKEN_TEXT:
+      // text before the root element ends the document for CXBMCTinyXML
+      if (!m_cdata && !IsBlankText())
+        return false;
+      break;
+    default:
+      return false;
+    }
+  }
+}
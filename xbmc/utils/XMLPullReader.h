@@ -0,0 +1,125 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#pragma once
+
+#include <string>
+
+/*!
+ * \brief Non-validating pull parser working directly on an XML buffer.
+ *
+ * Unlike CXBMCTinyXML no tree is built: Next() moves from token to token and names, text
+ * and attributes are only copied out when asked for. Comments, processing instructions and
+ * DOCTYPE declarations are skipped. The buffer must outlive the reader.
+ */
+class CXMLPullReader
+{
+public:
+  enum Token
+  {
+    TOKEN_START_ELEMENT, //!< start tag, also returned for empty elements (see IsEmptyElement)
+    TOKEN_END_ELEMENT,   //!< end tag, not returned for empty elements
+    TOKEN_TEXT,          //!< character data or a CDATA section
+    TOKEN_END_OF_DOCUMENT,
+    TOKEN_ERROR          //!< unterminated markup, the reader stays in this state
+  };
+
+  CXMLPullReader(const char* data, size_t length);
+  explicit CXMLPullReader(const std::string& data);
+
+  /*!
+   * \brief Convert a document the reader can't scan to UTF-8.
+   *
+   * The reader only handles encodings that keep markup in single ASCII bytes, like UTF-8 and
+   * the ISO-8859 family. Documents in other encodings, such as UTF-16, UTF-32 or EBCDIC, are
+   * detected by their byte order mark or XML declaration and converted.
+   * \param document the document, replaced by the converted one if needed
+   * \return false if the document needs converting but the conversion failed
+   */
+  static bool ConvertToUtf8(std::string& document);
+
+  /*!
+   * \brief Advance to the next token.
+   * \return the type of the new current token
+   */
+  Token Next();
+
+  /*!
+   * \brief Advance to the next start tag of the given name at any depth.
+   * \return true if found, false at the end of the document or on error
+   */
+  bool NextElement(const char* name);
+
+  /*!
+   * \brief Advance past the end of the current element, including all of its children.
+   * The current token must be TOKEN_START_ELEMENT.
+   * \return true on success, false if the element is not terminated
+   */
+  bool SkipElement();
+
+  Token GetToken() const { return m_token; }
+  bool IsEmptyElement() const { return m_token == TOKEN_START_ELEMENT && m_empty; }
+  //! nesting depth of the current token, the root element is at depth 0
+  int GetDepth() const { return m_depth; }
+  //! offset of the first character of the current token in the buffer
+  size_t GetTokenStart() const { return m_tokenStart; }
+  //! offset just past the last character of the current token in the buffer
+  size_t GetTokenEnd() const { return m_pos; }
+
+  bool IsName(const char* name) const;
+  std::string GetName() const;
+
+  /*!
+   * \brief Text of a TOKEN_TEXT token with entities decoded (CDATA is returned as is).
+   */
+  std::string GetText() const;
+
+  /*!
+   * \brief Value of an attribute of the current start tag, entities decoded.
+   * \return true if the attribute exists
+   */
+  bool GetAttribute(const char* name, std::string& value) const;
+
+  /*!
+   * \brief Lookups on the children of the current start tag, with the semantics of the
+   * XMLUtils functions of the same name: the first child element called \p tag is used and
+   * its first text is returned. The position of the reader doesn't change.
+   */
+  bool GetString(const char* tag, std::string& value) const;
+  bool GetInt(const char* tag, int& value) const;
+
+  /*!
+   * \brief Advance to the root element the way CXBMCTinyXML finds it, that is only if the
+   * first node after any declaration or comment is an element. Must be called first.
+   * \return true if the document has a root element
+   */
+  bool ReadRootElement();
+
+private:
+  bool StartsWith(const char* str) const;
+  bool SkipPast(const char* terminator);
+  bool ParseStartTag();
+  bool ParseEndTag();
+  bool IsBlankText() const;
+  int FindChild(const char* tag, std::string& value) const;
+
+  const char* m_data;
+  size_t m_length;
+  size_t m_pos = 0;
+  Token m_token = TOKEN_ERROR;
+  size_t m_tokenStart = 0;
+  size_t m_nameStart = 0;
+  size_t m_nameLength = 0;
+  size_t m_textStart = 0;
+  size_t m_textLength = 0;
+  bool m_cdata = false;
+  bool m_empty = false;
+  int m_depth = 0;
+  int m_openElements = 0;
+  bool m_error = false;
+};
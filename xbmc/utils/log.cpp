@@ -12,10 +12,15 @@
 #include "settings/AdvancedSettings.h"
 #include "settings/SettingsComponent.h"
 #include "threads/CriticalSection.h"
+#include "threads/Event.h"
 #include "threads/SingleLock.h"
 #include "threads/Thread.h"
 #include "utils/StringUtils.h"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #if defined(TARGET_POSIX)
 #include "platform/posix/utils/PosixInterfaceForCLog.h"
 typedef class CPosixInterfaceForCLog PlatformInterfaceForCLog;
@@ -34,10 +39,43 @@ static const char* const logLevelNames[] =
 
 namespace
 {
+// lines below LOGERROR are dropped while this many are waiting for the writer
+constexpr size_t MAX_QUEUED_LINES = 10000;
+
+struct LogEntry
+{
+  int level;
+  std::string line;
+  uint64_t threadId;
+  int year, month, day, hour, minute, second;
+  double millisecond;
+};
+
+class CLogWriter : public CThread
+{
+public:
+  CLogWriter() : CThread("LogWriter") {}
+
+  void Wake() { m_wakeEvent.Set(); }
+
+  void Stop()
+  {
+    m_bStop = true;
+    m_wakeEvent.Set();
+    StopThread(true);
+  }
+
+protected:
+  void Process() override;
+
+private:
+  CEvent m_wakeEvent;
+};
+
 class CLogGlobals
 {
 public:
-  ~CLogGlobals() = default;
+  ~CLogGlobals();
   PlatformInterfaceForCLog m_platform;
   int         m_repeatCount = 0;
   int         m_repeatLogLevel = -1;
@@ -45,52 +83,197 @@ public:
   int         m_logLevel = LOG_LEVEL_DEBUG;
   int         m_extraLogLevels = 0;
   CCriticalSection critSec;
+
+  // asynchronous mode: callers only queue their lines, the writer thread writes them in batches.
+  // m_queueSection guards the queue and the writer, it is never held while writing.
+  std::atomic_bool m_async{false};
+  CCriticalSection m_queueSection;
+  std::unique_ptr<CLogWriter> m_writer;
+  std::vector<LogEntry> m_queue;
+  unsigned int m_droppedLines = 0;
 };
 
 static CLogGlobals g_logState;
-}
 
-CLog::CLog() = default;
-
-CLog::~CLog() = default;
+LogEntry MakeLogEntry(int logLevel, std::string&& logString)
+{
+  LogEntry entry;
+  entry.level = logLevel;
+  entry.line = std::move(logString);
+  entry.threadId = static_cast<uint64_t>(CThread::GetCurrentThreadNativeId());
+  g_logState.m_platform.GetCurrentLocalTime(entry.year, entry.month, entry.day, entry.hour,
+                                            entry.minute, entry.second, entry.millisecond);
+  return entry;
+}
 
-void CLog::Close()
+void AppendLogLine(const LogEntry& entry, const std::string& line, std::string& output)
 {
-  CSingleLock waitLock(g_logState.critSec);
-  g_logState.m_platform.CloseLogFile();
-  g_logState.m_repeatLine.clear();
+  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
+
+  output += StringUtils::Format(prefixFormat,
+                                entry.year,
+                                entry.month,
+                                entry.day,
+                                entry.hour,
+                                entry.minute,
+                                entry.second,
+                                static_cast<int>(entry.millisecond),
+                                entry.threadId,
+                                levelNames[entry.level]);
+  /* fixup newline alignment, number of spaces should equal prefix length */
+  std::string strData(line);
+  StringUtils::Replace(strData, "\n", "\n                                            ");
+  output += strData;
+  output += '\n';
 }
 
-void CLog::LogString(int logLevel, std::string&& logString)
+// collapses repeated lines and writes the rest with a single write, g_logState.critSec must be held
+void WriteLogEntries(std::vector<LogEntry>& entries, unsigned int droppedLines)
 {
-  CSingleLock waitLock(g_logState.critSec);
-  std::string strData(logString);
-  StringUtils::TrimRight(strData);
-  if (!strData.empty())
+  std::string output;
+  for (LogEntry& entry : entries)
   {
-    if (g_logState.m_repeatLogLevel == logLevel && g_logState.m_repeatLine == strData)
+    std::string& strData = entry.line;
+    StringUtils::TrimRight(strData);
+    if (strData.empty())
+      continue;
+
+    if (g_logState.m_repeatLogLevel == entry.level && g_logState.m_repeatLine == strData)
     {
       g_logState.m_repeatCount++;
-      return;
+      continue;
     }
     else if (g_logState.m_repeatCount)
     {
       std::string strData2 = StringUtils::Format("Previous line repeats %d times.",
                                                 g_logState.m_repeatCount);
-      PrintDebugString(strData2);
-      WriteLogString(g_logState.m_repeatLogLevel, strData2);
+      CLog::PrintDebugString(strData2);
+      LogEntry repeat = entry;
+      repeat.level = g_logState.m_repeatLogLevel;
+      AppendLogLine(repeat, strData2, output);
       g_logState.m_repeatCount = 0;
     }
 
     g_logState.m_repeatLine = strData;
-    g_logState.m_repeatLogLevel = logLevel;
+    g_logState.m_repeatLogLevel = entry.level;
+
+    CLog::PrintDebugString(strData);
+
+    AppendLogLine(entry, strData, output);
+  }
+
+  if (droppedLines > 0 && !entries.empty())
+  {
+    const std::string strData = StringUtils::Format(
+        "%u log lines were dropped, the log writer could not keep up.", droppedLines);
+    LogEntry dropped = entries.back();
+    dropped.level = LOGWARNING;
+    AppendLogLine(dropped, strData, output);
+  }
+
+  if (!output.empty())
+  {
+    output.pop_back(); // the platform adds the last line break
+    g_logState.m_platform.WriteStringToLog(output);
+  }
+}
+
+// writes everything queued so far, g_logState.critSec must be held
+void DrainLogQueue()
+{
+  std::vector<LogEntry> entries;
+  unsigned int droppedLines;
+  {
+    CSingleLock lock(g_logState.m_queueSection);
+    entries.swap(g_logState.m_queue);
+    droppedLines = g_logState.m_droppedLines;
+    g_logState.m_droppedLines = 0;
+  }
+  if (!entries.empty())
+    WriteLogEntries(entries, droppedLines);
+}
 
-    PrintDebugString(strData);
+void StopLogWriter()
+{
+  std::unique_ptr<CLogWriter> writer;
+  {
+    CSingleLock lock(g_logState.m_queueSection);
+    g_logState.m_async = false;
+    writer = std::move(g_logState.m_writer);
+  }
+  if (writer)
+    writer->Stop();
+
+  CSingleLock waitLock(g_logState.critSec);
+  DrainLogQueue();
+}
+
+void CLogWriter::Process()
+{
+  while (!m_bStop)
+  {
+    m_wakeEvent.WaitMSec(500);
 
-    WriteLogString(logLevel, strData);
+    CSingleLock waitLock(g_logState.critSec);
+    DrainLogQueue();
   }
 }
 
+CLogGlobals::~CLogGlobals()
+{
+  StopLogWriter();
+}
+}
+
+CLog::CLog() = default;
+
+CLog::~CLog() = default;
+
+void CLog::Close()
+{
+  StopLogWriter();
+  CSingleLock waitLock(g_logState.critSec);
+  g_logState.m_platform.CloseLogFile();
+  g_logState.m_repeatLine.clear();
+}
+
+void CLog::LogString(int logLevel, std::string&& logString)
+{
+  LogEntry entry = MakeLogEntry(logLevel, std::move(logString));
+
+  if (g_logState.m_async)
+  {
+    {
+      CSingleLock lock(g_logState.m_queueSection);
+      if (g_logState.m_queue.size() < MAX_QUEUED_LINES || (logLevel & LOGMASK) >= LOGERROR)
+      {
+        g_logState.m_queue.emplace_back(std::move(entry));
+        if (g_logState.m_writer)
+          g_logState.m_writer->Wake();
+      }
+      else
+      {
+        g_logState.m_droppedLines++;
+      }
+    }
+
+    // a severe or fatal line may be the last one before a crash, don't keep it waiting
+    if ((logLevel & LOGMASK) >= LOGSEVERE)
+    {
+      CSingleLock waitLock(g_logState.critSec);
+      DrainLogQueue();
+    }
+    return;
+  }
+
+  CSingleLock waitLock(g_logState.critSec);
+  // keep the order of lines queued before asynchronous logging was switched off
+  DrainLogQueue();
+  std::vector<LogEntry> entries;
+  entries.emplace_back(std::move(entry));
+  WriteLogEntries(entries, 0);
+}
+
 void CLog::LogString(int logLevel, int component, std::string&& logString)
 {
   if (CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->CanLogComponent(component) && IsLogLevelLogged(logLevel))
@@ -163,6 +346,36 @@ void CLog::SetExtraLogLevels(int level)
   g_logState.m_extraLogLevels = level;
 }
 
+void CLog::SetAsync(bool async)
+{
+  if (!async)
+  {
+    StopLogWriter();
+    return;
+  }
+
+  {
+    CSingleLock lock(g_logState.m_queueSection);
+    if (g_logState.m_writer)
+      return;
+  }
+
+  // the writer logs its start, so it must be created without holding any log lock
+  std::unique_ptr<CLogWriter> writer(new CLogWriter());
+  writer->Create();
+
+  {
+    CSingleLock lock(g_logState.m_queueSection);
+    if (!g_logState.m_writer)
+    {
+      g_logState.m_writer = std::move(writer);
+      g_logState.m_async = true;
+    }
+  }
+  if (writer)
+    writer->Stop();
+}
+
 bool CLog::IsLogLevelLogged(int loglevel)
 {
   const int extras = (loglevel & ~LOGMASK);
@@ -185,29 +398,3 @@ void CLog::PrintDebugString(const std::string& line)
   g_logState.m_platform.PrintDebugString(line);
 #endif // defined(_DEBUG) || defined(PROFILE)
 }
-
-bool CLog::WriteLogString(int logLevel, const std::string& logString)
-{
-  static const char* prefixFormat = "%02d-%02d-%02d %02d:%02d:%02d.%03d T:%" PRIu64" %7s: ";
-
-  std::string strData(logString);
-  /* fixup newline alignment, number of spaces should equal prefix length */
-  StringUtils::Replace(strData, "\n", "\n                                            ");
-
-  int year, month, day, hour, minute, second;
-  double millisecond;
-  g_logState.m_platform.GetCurrentLocalTime(year, month, day, hour, minute, second, millisecond);
-
-  strData = StringUtils::Format(prefixFormat,
-                                  year,
-                                  month,
-                                  day,
-                                  hour,
-                                  minute,
-                                  second,
-                                  static_cast<int>(millisecond),
-                                  static_cast<uint64_t>(CThread::GetCurrentThreadNativeId()),
-                                  levelNames[logLevel]) + strData;
-
-  return g_logState.m_platform.WriteStringToLog(strData);
-}
@@ -96,10 +96,14 @@ public:
   static void SetLogLevel(int level);
   static int  GetLogLevel();
   static void SetExtraLogLevels(int level);
+  /*!
+   * \brief Queue lines for a background writer instead of writing them on the calling thread.
+   * Severe and fatal lines are still written immediately, together with everything queued before.
+   */
+  static void SetAsync(bool async);
   static bool IsLogLevelLogged(int loglevel);
 
 protected:
   static void LogString(int logLevel, std::string&& logString);
   static void LogString(int logLevel, int component, std::string&& logString);
-  static bool WriteLogString(int logLevel, const std::string& logString);
 };
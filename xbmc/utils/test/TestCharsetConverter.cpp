@@ -257,6 +257,40 @@ TEST_F(TestCharsetConverter, wToUTF8)
   EXPECT_STREQ(refstra1.c_str(), varstra1.c_str());
 }
 
+TEST_F(TestCharsetConverter, utf8ToUtf32)
+{
+  std::u32string varstr32;
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32("test \xC3\xA9\xE2\x82\xAC\xF0\x9F\x90\xAD", varstr32));
+  EXPECT_EQ(U"test \u00E9\u20AC\U0001F42D", varstr32);
+
+  // invalid sequences are skipped unless asked to fail
+  const std::string invalid = "a\xC3(b\xE0\x80\x80" "c\xED\xA0\x80" "d\xF0\x9F";
+  EXPECT_FALSE(g_charsetConverter.utf8ToUtf32(invalid, varstr32, true));
+  EXPECT_TRUE(g_charsetConverter.utf8ToUtf32(invalid, varstr32, false));
+  EXPECT_EQ(U"a(bcd", varstr32);
+}
+
+TEST_F(TestCharsetConverter, utf32ToUtf8)
+{
+  const std::u32string refstr32 = U"ascii only, then \u00E9\u20AC\U0001F42D";
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf32ToUtf8(refstr32, varstra1));
+  EXPECT_EQ("ascii only, then \xC3\xA9\xE2\x82\xAC\xF0\x9F\x90\xAD", varstra1);
+  EXPECT_EQ(refstr32, g_charsetConverter.utf8ToUtf32(varstra1));
+}
+
+TEST_F(TestCharsetConverter, utf16LEtoUTF8_surrogates)
+{
+  std::u16string refstr16 = u"t\u00E9\U0001F42D!";
+#ifdef WORDS_BIGENDIAN
+  for (char16_t& unit : refstr16)
+    unit = static_cast<char16_t>((unit << 8) | (unit >> 8));
+#endif
+  varstra1.clear();
+  EXPECT_TRUE(g_charsetConverter.utf16LEtoUTF8(refstr16, varstra1));
+  EXPECT_EQ("t\xC3\xA9\xF0\x9F\x90\xAD!", varstra1);
+}
+
 //TEST_F(TestCharsetConverter, utf16BEtoUTF8)
 //{
 //  refstr16_1.assign(refutf16BE);
@@ -9,6 +9,7 @@
 #include "dbwrappers/qry_dat.h"
 #include "music/MusicDatabase.h"
 #include "utils/DatabaseUtils.h"
+#include "utils/SortUtils.h"
 #include "utils/StringUtils.h"
 #include "utils/Variant.h"
 #include "video/VideoDatabase.h"
@@ -1349,6 +1350,38 @@ TEST(TestDatabaseUtils, BuildLimitClause)
   EXPECT_STREQ(" LIMIT 100", a.c_str());
 }
 
+TEST(TestDatabaseUtils, BuildOrderByClause)
+{
+  SortDescription sorting;
+  sorting.sortBy = SortByDateAdded;
+  sorting.sortOrder = SortOrderDescending;
+  EXPECT_STREQ("movie_view.dateAdded DESC, movie_view.idMovie DESC",
+               DatabaseUtils::BuildOrderByClause(sorting, MediaTypeMovie).c_str());
+
+  sorting.sortBy = SortByLastPlayed;
+  sorting.sortAttributes = SortAttributeIgnoreLabel;
+  EXPECT_STREQ("episode_view.lastPlayed DESC, episode_view.idEpisode",
+               DatabaseUtils::BuildOrderByClause(sorting, MediaTypeEpisode).c_str());
+
+  sorting.sortBy = SortByRandom;
+  sorting.sortAttributes = SortAttributeNone;
+  EXPECT_STREQ("RANDOM()", DatabaseUtils::BuildOrderByClause(sorting, MediaTypeMovie).c_str());
+
+  // text is compared with the locale's collation in memory
+  sorting.sortBy = SortByLastPlayed;
+  EXPECT_TRUE(DatabaseUtils::BuildOrderByClause(sorting, MediaTypeMovie).empty());
+
+  sorting.sortBy = SortByTitle;
+  EXPECT_TRUE(DatabaseUtils::BuildOrderByClause(sorting, MediaTypeMovie).empty());
+
+  sorting.sortBy = SortByYear;
+  EXPECT_TRUE(DatabaseUtils::BuildOrderByClause(sorting, MediaTypeMovie).empty());
+  EXPECT_TRUE(DatabaseUtils::BuildOrderByClause(sorting, MediaTypeEpisode).empty());
+
+  sorting.sortBy = SortByEpisodeNumber;
+  EXPECT_TRUE(DatabaseUtils::BuildOrderByClause(sorting, MediaTypeEpisode).empty());
+}
+
 // class DatabaseUtils
 // {
 // public:
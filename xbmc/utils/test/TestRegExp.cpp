@@ -16,6 +16,8 @@
 #include "utils/StringUtils.h"
 #include "utils/log.h"
 
+#include <memory>
+
 #include <gtest/gtest.h>
 
 TEST(TestRegExp, RegFind)
@@ -122,6 +124,99 @@ TEST(TestRegExp, operatorEqual)
   EXPECT_STREQ("string", match.c_str());
 }
 
+TEST(TestRegExp, SharedPattern)
+{
+  std::string match;
+
+  // both objects get the same cached compiled pattern, each keeps its own match data
+  std::unique_ptr<CRegExp> first(new CRegExp(true));
+  CRegExp second(true);
+  EXPECT_TRUE(first->RegComp("^(\\w+)\\s(\\d+)$", CRegExp::StudyWithJitComp));
+  EXPECT_TRUE(second.RegComp("^(\\w+)\\s(\\d+)$", CRegExp::StudyWithJitComp));
+  EXPECT_EQ(0, first->RegFind("Test 1"));
+  EXPECT_EQ(0, second.RegFind("Other 22"));
+  EXPECT_STREQ("Test", first->GetMatch(1).c_str());
+  EXPECT_STREQ("Other", second.GetMatch(1).c_str());
+
+  // the pattern stays usable when another user of it goes away
+  first.reset();
+  EXPECT_STREQ("22", second.GetMatch(2).c_str());
+  EXPECT_EQ(0, second.RegFind("TEST 333"));
+  EXPECT_STREQ("333", second.GetMatch(2).c_str());
+
+  // same expression with other options is compiled on its own
+  CRegExp caseSensitive(false);
+  EXPECT_TRUE(caseSensitive.RegComp("^test$", CRegExp::StudyWithJitComp));
+  CRegExp caseless(true);
+  EXPECT_TRUE(caseless.RegComp("^test$", CRegExp::StudyWithJitComp));
+  EXPECT_EQ(-1, caseSensitive.RegFind("TEST"));
+  EXPECT_EQ(0, caseless.RegFind("TEST"));
+}
+
+TEST(TestRegExp, CachedUnstudiedPatterns)
+{
+  // unstudied patterns like those of scrapers are cached as well, and stay usable after
+  // enough other patterns went through the cache to evict them
+  CRegExp scraper(true, CRegExp::autoUtf8);
+  EXPECT_TRUE(scraper.RegComp("<title>([^<]*)</title>"));
+  for (int i = 0; i < 20000; i++)
+  {
+    CRegExp regex;
+    EXPECT_TRUE(regex.RegComp(StringUtils::Format("^pattern %d (\\w+)$", i)));
+    if (i % 1000 == 0)
+      EXPECT_EQ(0, regex.RegFind(StringUtils::Format("pattern %d match", i)));
+  }
+  EXPECT_EQ(6, scraper.RegFind("<html><TITLE>Movie</TITLE>"));
+  EXPECT_STREQ("Movie", scraper.GetMatch(1).c_str());
+
+  CRegExp again(true, CRegExp::autoUtf8);
+  EXPECT_TRUE(again.RegComp("<title>([^<]*)</title>"));
+  EXPECT_EQ(0, again.RegFind("<title>Other</title>"));
+  EXPECT_STREQ("Other", again.GetMatch(1).c_str());
+}
+
+TEST(TestRegExp, CopySemantics)
+{
+  CRegExp regex;
+  EXPECT_TRUE(regex.RegComp("^(Test)\\s*(.*)\\.", CRegExp::StudyRegExp));
+  EXPECT_EQ(0, regex.RegFind("Test string."));
+
+  // copies take over the match as well as the pattern
+  CRegExp regexcopy(regex);
+  EXPECT_STREQ("string", regexcopy.GetMatch(2).c_str());
+  EXPECT_STREQ(regex.GetPattern().c_str(), regexcopy.GetPattern().c_str());
+
+  // and are not affected by the original being compiled again or going away
+  EXPECT_TRUE(regex.RegComp("^Other$"));
+  EXPECT_EQ(-1, regex.RegFind("Test string."));
+  EXPECT_EQ(0, regexcopy.RegFind("Test again."));
+  EXPECT_STREQ("again", regexcopy.GetMatch(2).c_str());
+
+  regex = regexcopy;
+  const CRegExp& self = regex;
+  regex = self;
+  EXPECT_EQ(0, regex.RegFind("Test self."));
+  EXPECT_STREQ("self", regex.GetMatch(2).c_str());
+
+  CRegExp empty;
+  regexcopy = empty;
+  EXPECT_TRUE(regexcopy.GetPattern().empty());
+  EXPECT_EQ(-1, regexcopy.RegFind("Test string."));
+  EXPECT_EQ(0, regex.RegFind("Test still."));
+}
+
+TEST(TestRegExp, JitStackLimit)
+{
+  // every repetition of the group takes JIT stack, a long subject runs past the default JIT
+  // stack and has to be matched by the interpreter instead
+  CRegExp regex;
+  EXPECT_TRUE(regex.RegComp("^(a|b)*c$", CRegExp::StudyWithJitComp));
+  const std::string subject = std::string(3000, 'a') + "c";
+  EXPECT_EQ(0, regex.RegFind(subject));
+  EXPECT_EQ(static_cast<int>(subject.length()), regex.GetFindLen());
+  EXPECT_EQ(-1, regex.RegFind(std::string(3000, 'a')));
+}
+
 class TestRegExpLog : public testing::Test
 {
 protected:
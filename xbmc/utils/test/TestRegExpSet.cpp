@@ -0,0 +1,88 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "utils/RegExpSet.h"
+
+#include <gtest/gtest.h>
+
+TEST(TestRegExpSet, FindFirst)
+{
+  CRegExpSet set(true, CRegExp::autoUtf8);
+  std::vector<std::string> patterns = {
+    "s([0-9]+)[ ._x-]*e([0-9]+)",
+    "[\\._ -]()e(?:p[ ._-]?)?([0-9]+)",
+    "([0-9]{4})[\\.-]([0-9]{2})[\\.-]([0-9]{2})",
+  };
+
+  EXPECT_TRUE(set.Compile(patterns));
+  EXPECT_EQ(3U, set.Size());
+
+  EXPECT_EQ(0, set.FindFirst("foo.S02E03.mkv"));
+  EXPECT_STREQ("02", set.GetRegExp(0).GetMatch(1).c_str());
+  EXPECT_STREQ("03", set.GetRegExp(0).GetMatch(2).c_str());
+
+  EXPECT_EQ(1, set.FindFirst("foo.Ep03.mkv"));
+  EXPECT_STREQ("03", set.GetRegExp(1).GetMatch(2).c_str());
+
+  EXPECT_EQ(2, set.FindFirst("foo.2009-11-05.mkv"));
+  EXPECT_EQ(-1, set.FindFirst("foo.mkv"));
+  EXPECT_EQ(-1, set.FindFirst(""));
+}
+
+TEST(TestRegExpSet, FirstMatchWins)
+{
+  CRegExpSet set;
+  std::vector<std::string> patterns = { "b", "a", "ab" };
+
+  EXPECT_TRUE(set.Compile(patterns));
+  EXPECT_EQ(0, set.FindFirst("xaby"));
+  // resuming after a rejected match keeps the list order
+  EXPECT_EQ(1, set.FindFirst("xaby", 1));
+  EXPECT_EQ(2, set.FindFirst("xaby", 2));
+  EXPECT_EQ(-1, set.FindFirst("xaby", 3));
+}
+
+TEST(TestRegExpSet, Caseless)
+{
+  CRegExpSet caseless(true);
+  CRegExpSet caseSensitive(false);
+  std::vector<std::string> patterns = { "PART\\.([0-9]+)" };
+
+  EXPECT_TRUE(caseless.Compile(patterns));
+  EXPECT_TRUE(caseSensitive.Compile(patterns));
+  EXPECT_EQ(0, caseless.FindFirst("foo.part.3.mkv"));
+  EXPECT_EQ(-1, caseSensitive.FindFirst("foo.part.3.mkv"));
+  EXPECT_EQ(0, caseSensitive.FindFirst("foo.PART.3.mkv"));
+}
+
+TEST(TestRegExpSet, InvalidPattern)
+{
+  CRegExpSet set;
+  std::vector<std::string> patterns = { "(", "foo" };
+
+  EXPECT_FALSE(set.Compile(patterns));
+  EXPECT_EQ(2U, set.Size());
+  EXPECT_EQ(1, set.FindFirst("foo"));
+}
+
+TEST(TestRegExpSet, Statistics)
+{
+  CRegExpSet set;
+  std::vector<std::string> patterns = { "x", "y" };
+
+  EXPECT_TRUE(set.Compile(patterns));
+  set.FindFirst("y");
+  set.FindFirst("y");
+  set.FindFirst("x");
+  EXPECT_EQ(1U, set.GetHits(0));
+  EXPECT_EQ(2U, set.GetHits(1));
+
+  set.ResetStatistics();
+  EXPECT_EQ(0U, set.GetHits(0));
+  EXPECT_EQ(0U, set.GetHits(1));
+}
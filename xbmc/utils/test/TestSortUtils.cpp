@@ -9,6 +9,8 @@
 #include "utils/SortUtils.h"
 #include "utils/Variant.h"
 
+#include <string.h>
+
 #include <gtest/gtest.h>
 
 TEST(TestSortUtils, Sort_SortBy)
@@ -121,3 +123,77 @@ TEST(TestSortUtils, GetFieldsForSorting)
   EXPECT_EQ(FieldTrackNumber, *it);
   EXPECT_EQ((unsigned int)5, fields.size());
 }
+
+TEST(TestSortUtils, Sort_Numbers)
+{
+  SortItems items;
+  const char *labels[] = { "Track 10", "track 2", "Track 1", "Track 02", "Track 1b", "Track" };
+  for (const char *label : labels)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = label;
+    items.push_back(item);
+  }
+
+  SortUtils::Sort(SortByLabel, SortOrderAscending, SortAttributeNone, items);
+
+  ASSERT_EQ(6u, items.size());
+  EXPECT_STREQ("Track", (*items.at(0))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 1", (*items.at(1))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 1b", (*items.at(2))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("track 2", (*items.at(3))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 02", (*items.at(4))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Track 10", (*items.at(5))[FieldLabel].asString().c_str());
+}
+
+TEST(TestSortUtils, Sort_Limits)
+{
+  SortItems items;
+  for (int i = 0; i < 100; i++)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = "Item " + std::to_string((i * 37) % 50);
+    (*item)[FieldId] = i;
+    items.push_back(item);
+  }
+
+  SortDescription desc;
+  desc.sortBy = SortByLabel;
+  desc.sortOrder = SortOrderDescending;
+  desc.limitStart = 3;
+  desc.limitEnd = 8;
+  SortUtils::Sort(desc, items);
+
+  // every label exists twice, equal items have to keep their order
+  ASSERT_EQ(5u, items.size());
+  EXPECT_STREQ("Item 48", (*items.at(0))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Item 47", (*items.at(1))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Item 47", (*items.at(2))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Item 46", (*items.at(3))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("Item 46", (*items.at(4))[FieldLabel].asString().c_str());
+  EXPECT_LT((*items.at(1))[FieldId].asInteger(), (*items.at(2))[FieldId].asInteger());
+  EXPECT_LT((*items.at(3))[FieldId].asInteger(), (*items.at(4))[FieldId].asInteger());
+}
+
+TEST(TestSortUtils, Sort_SortSpecial)
+{
+  SortItems items;
+  const char *labels[] = { "B", "..", "A", "C" };
+  for (const char *label : labels)
+  {
+    SortItemPtr item(new SortItem());
+    (*item)[FieldLabel] = label;
+    (*item)[FieldFolder] = strcmp(label, "C") == 0;
+    if (strcmp(label, "..") == 0)
+      (*item)[FieldSortSpecial] = SortSpecialOnTop;
+    items.push_back(item);
+  }
+
+  SortUtils::Sort(SortByLabel, SortOrderDescending, SortAttributeNone, items);
+
+  ASSERT_EQ(4u, items.size());
+  EXPECT_STREQ("..", (*items.at(0))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("C", (*items.at(1))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("B", (*items.at(2))[FieldLabel].asString().c_str());
+  EXPECT_STREQ("A", (*items.at(3))[FieldLabel].asString().c_str());
+}
@@ -0,0 +1,178 @@
+/*
+ *  Copyright (C) 2005-2018 Team Kodi
+ *  This file is part of Kodi - https://kodi.tv
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSES/README.md for more information.
+ */
+
+#include "utils/XMLPullReader.h"
+
+#include <gtest/gtest.h>
+
+TEST(TestXMLPullReader, Tokens)
+{
+  std::string xml = "<?xml version=\"1.0\"?>\n"
+                    "<!-- comment -->\n"
+                    "<root a=\"1\"><child/>text &amp; more<![CDATA[<raw>]]></root>";
+  CXMLPullReader reader(xml);
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_TEXT, reader.Next());
+  EXPECT_EQ(CXMLPullReader::TOKEN_TEXT, reader.Next());
+  EXPECT_EQ(CXMLPullReader::TOKEN_START_ELEMENT, reader.Next());
+  EXPECT_TRUE(reader.IsName("root"));
+  EXPECT_FALSE(reader.IsEmptyElement());
+  EXPECT_EQ(0, reader.GetDepth());
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_START_ELEMENT, reader.Next());
+  EXPECT_STREQ("child", reader.GetName().c_str());
+  EXPECT_TRUE(reader.IsEmptyElement());
+  EXPECT_EQ(1, reader.GetDepth());
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_TEXT, reader.Next());
+  EXPECT_STREQ("text & more", reader.GetText().c_str());
+  EXPECT_EQ(CXMLPullReader::TOKEN_TEXT, reader.Next());
+  EXPECT_STREQ("<raw>", reader.GetText().c_str());
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_END_ELEMENT, reader.Next());
+  EXPECT_TRUE(reader.IsName("root"));
+  EXPECT_EQ(0, reader.GetDepth());
+  EXPECT_EQ(xml.size(), reader.GetTokenEnd());
+  EXPECT_EQ(CXMLPullReader::TOKEN_END_OF_DOCUMENT, reader.Next());
+}
+
+TEST(TestXMLPullReader, Attributes)
+{
+  std::string xml = "<rating name='imdb' max=\"10\" default=\"a &gt; b\"/>";
+  CXMLPullReader reader(xml);
+  std::string value;
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_START_ELEMENT, reader.Next());
+  EXPECT_TRUE(reader.GetAttribute("name", value));
+  EXPECT_STREQ("imdb", value.c_str());
+  EXPECT_TRUE(reader.GetAttribute("max", value));
+  EXPECT_STREQ("10", value.c_str());
+  EXPECT_TRUE(reader.GetAttribute("default", value));
+  EXPECT_STREQ("a > b", value.c_str());
+  EXPECT_FALSE(reader.GetAttribute("min", value));
+}
+
+TEST(TestXMLPullReader, GetString)
+{
+  std::string xml = "<episodedetails>"
+                    "  <actor><name>Someone</name></actor>"
+                    "  <name>Show &#x263A;</name>"
+                    "  <season>\n  2\n</season>"
+                    "  <episode>5</episode>"
+                    "  <empty/>"
+                    "</episodedetails>";
+  CXMLPullReader reader(xml);
+  std::string value;
+  int number = 0;
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_START_ELEMENT, reader.Next());
+  // only direct children are looked at
+  EXPECT_TRUE(reader.GetString("name", value));
+  EXPECT_STREQ("Show \xE2\x98\xBA", value.c_str());
+  EXPECT_TRUE(reader.GetInt("season", number));
+  EXPECT_EQ(2, number);
+  EXPECT_TRUE(reader.GetInt("episode", number));
+  EXPECT_EQ(5, number);
+  EXPECT_TRUE(reader.GetString("empty", value));
+  EXPECT_TRUE(value.empty());
+  EXPECT_FALSE(reader.GetInt("empty", number));
+  EXPECT_FALSE(reader.GetString("missing", value));
+
+  // lookups don't move the reader
+  EXPECT_TRUE(reader.IsName("episodedetails"));
+  EXPECT_TRUE(reader.SkipElement());
+  EXPECT_EQ(xml.size(), reader.GetTokenEnd());
+}
+
+TEST(TestXMLPullReader, NextElement)
+{
+  std::string xml = "<episodedetails><episode>1</episode></episodedetails>\n"
+                    "<episodedetails><episode>2</episode></episodedetails>";
+  CXMLPullReader reader(xml);
+  int episode = 0;
+
+  EXPECT_TRUE(reader.NextElement("episodedetails"));
+  EXPECT_TRUE(reader.GetInt("episode", episode));
+  EXPECT_EQ(1, episode);
+  EXPECT_TRUE(reader.SkipElement());
+  EXPECT_TRUE(reader.NextElement("episodedetails"));
+  EXPECT_TRUE(reader.GetInt("episode", episode));
+  EXPECT_EQ(2, episode);
+  EXPECT_FALSE(reader.NextElement("episodedetails"));
+}
+
+TEST(TestXMLPullReader, Malformed)
+{
+  const std::string xml = "<root><child";
+  CXMLPullReader reader(xml);
+
+  EXPECT_EQ(CXMLPullReader::TOKEN_START_ELEMENT, reader.Next());
+  EXPECT_EQ(CXMLPullReader::TOKEN_ERROR, reader.Next());
+  EXPECT_EQ(CXMLPullReader::TOKEN_ERROR, reader.Next());
+  EXPECT_FALSE(reader.SkipElement());
+}
+
+TEST(TestXMLPullReader, ReadRootElement)
+{
+  const std::string movieXml = "\xEF\xBB\xBF<?xml version=\"1.0\"?>\n<movie></movie>";
+  const std::string urlXml = "http://www.imdb.com/title/tt0000001/";
+  const std::string urlFirstXml = "http://www.imdb.com/title/tt0000001/\n<movie></movie>";
+  CXMLPullReader movie(movieXml);
+  CXMLPullReader url(urlXml);
+  CXMLPullReader urlFirst(urlFirstXml);
+  CXMLPullReader empty(nullptr, 0);
+
+  EXPECT_TRUE(movie.ReadRootElement());
+  EXPECT_TRUE(movie.IsName("movie"));
+  EXPECT_FALSE(url.ReadRootElement());
+  EXPECT_FALSE(urlFirst.ReadRootElement());
+  EXPECT_FALSE(empty.ReadRootElement());
+}
+
+TEST(TestXMLPullReader, ConvertToUtf8)
+{
+  const std::string nfo = "<?xml version=\"1.0\" encoding=\"UTF-16\"?>\n"
+                          "<episodedetails><title>Caf\xC3\xA9</title><episode>3</episode></episodedetails>";
+  const std::wstring wideNfo = L"<?xml version=\"1.0\" encoding=\"UTF-16\"?>\n"
+                               L"<episodedetails><title>Caf\u00E9</title><episode>3</episode></episodedetails>";
+
+  // UTF-16LE with byte order mark, as written by Windows tools
+  std::string utf16le = "\xFF\xFE";
+  // UTF-16BE without, detected from the declaration
+  std::string utf16be;
+  for (wchar_t c : wideNfo)
+  {
+    utf16le += static_cast<char>(c & 0xFF);
+    utf16le += static_cast<char>(c >> 8);
+    utf16be += static_cast<char>(c >> 8);
+    utf16be += static_cast<char>(c & 0xFF);
+  }
+
+  for (std::string* document : {&utf16le, &utf16be})
+  {
+    EXPECT_TRUE(CXMLPullReader::ConvertToUtf8(*document));
+    CXMLPullReader reader(*document);
+    EXPECT_TRUE(reader.ReadRootElement());
+    EXPECT_TRUE(reader.IsName("episodedetails"));
+    std::string title;
+    int episode = -1;
+    EXPECT_TRUE(reader.GetString("title", title));
+    EXPECT_STREQ("Caf\xC3\xA9", title.c_str());
+    EXPECT_TRUE(reader.GetInt("episode", episode));
+    EXPECT_EQ(3, episode);
+  }
+
+  // ASCII compatible documents are left alone
+  std::string utf8 = nfo;
+  EXPECT_TRUE(CXMLPullReader::ConvertToUtf8(utf8));
+  EXPECT_EQ(nfo, utf8);
+  std::string latin1 = "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n<movie><title>Caf\xE9</title></movie>";
+  const std::string latin1Copy = latin1;
+  EXPECT_TRUE(CXMLPullReader::ConvertToUtf8(latin1));
+  EXPECT_EQ(latin1Copy, latin1);
+}
@@ -122,6 +122,46 @@ TEST_F(Testlog, MemDump)
   EXPECT_TRUE(XFILE::CFile::Delete(logfile));
 }
 
+TEST_F(Testlog, AsyncLog)
+{
+  std::string logfile, logstring;
+  char buf[100];
+  ssize_t bytesread;
+  XFILE::CFile file;
+  CRegExp regex;
+
+  std::string appName = CCompileInfo::GetAppName();
+  StringUtils::ToLower(appName);
+  logfile = CSpecialProtocol::TranslatePath("special://temp/") + appName + ".log";
+  EXPECT_TRUE(CLog::Init(CSpecialProtocol::TranslatePath("special://temp/").c_str()));
+  EXPECT_TRUE(XFILE::CFile::Exists(logfile));
+
+  CLog::SetAsync(true);
+  CLog::Log(LOGDEBUG, "async debug log message");
+  CLog::Log(LOGDEBUG, "async repeated log message");
+  CLog::Log(LOGDEBUG, "async repeated log message");
+  CLog::Log(LOGNOTICE, "async notice log message");
+  CLog::Close();
+
+  EXPECT_TRUE(file.Open(logfile));
+  while ((bytesread = file.Read(buf, sizeof(buf) - 1)) > 0)
+  {
+    buf[bytesread] = '\0';
+    logstring.append(buf);
+  }
+  file.Close();
+  EXPECT_FALSE(logstring.empty());
+
+  EXPECT_TRUE(regex.RegComp(".*DEBUG: async debug log message.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*DEBUG: Previous line repeats 1 times.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+  EXPECT_TRUE(regex.RegComp(".*NOTICE: async notice log message.*"));
+  EXPECT_GE(regex.RegFind(logstring), 0);
+
+  EXPECT_TRUE(XFILE::CFile::Delete(logfile));
+}
+
 TEST_F(Testlog, SetLogLevel)
 {
   std::string logfile;
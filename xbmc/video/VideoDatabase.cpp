@@ -24,6 +24,7 @@
 #include "dialogs/GUIDialogKaiToast.h"
 #include "dialogs/GUIDialogProgress.h"
 #include "dialogs/GUIDialogYesNo.h"
+#include "filesystem/ChangeJournal.h"
 #include "filesystem/Directory.h"
 #include "filesystem/File.h"
 #include "filesystem/MultiPathDirectory.h"
@@ -739,6 +740,19 @@ bool CVideoDatabase::GetSubPaths(const std::string &basepath, std::vector<std::p
   return false;
 }
 
+bool CVideoDatabase::HasInvalidatedSubPaths(const std::string &basepath)
+{
+  if (!m_pDB || !m_pDS)
+    return true;
+
+  std::string path(basepath);
+  URIUtils::AddSlashAtEnd(path);
+  // paths that were never hashed are NULL, cleared hashes are empty
+  const std::string sql = PrepareSQL("SELECT 1 FROM path WHERE SUBSTR(strPath,1,%i)='%s' AND strHash=''",
+                                     StringUtils::utf8_strlen(path.c_str()), path.c_str());
+  return !GetSingleValue(sql).empty();
+}
+
 int CVideoDatabase::AddPath(const std::string& strPath, const std::string &parentPath /*= "" */, const CDateTime& dateAdded /* = CDateTime() */)
 {
   std::string strSQL;
@@ -999,6 +1013,10 @@ bool CVideoDatabase::SetPathHash(const std::string &path, const std::string &has
     std::string strSQL=PrepareSQL("update path set strHash='%s' where idPath=%ld", hash.c_str(), idPath);
     m_pDS->exec(strSQL);
 
+    // a clean change journal would keep the scanner from looking at the path again
+    if (hash.empty())
+      XFILE::CChangeJournal::GetInstance().MarkChanged(path);
+
     return true;
   }
   catch (...)
@@ -5007,6 +5025,7 @@ void CVideoDatabase::RemoveContentForPath(const std::string& strPath, CGUIDialog
         }
         m_pDS2->close();
         m_pDS2->exec(PrepareSQL("update path set strContent='', strScraper='', strHash='',strSettings='',useFolderNames=0,scanRecursive=0 where idPath=%i", i.first));
+        XFILE::CChangeJournal::GetInstance().MarkChanged(i.second);
       }
     }
   }
@@ -5059,6 +5078,8 @@ void CVideoDatabase::SetScraperForPath(const std::string& filePath, const Scrape
       strSQL=PrepareSQL("update path set strContent='%s', strScraper='%s', scanRecursive=%i, useFolderNames=%i, strSettings='%s', noUpdate=%i, exclude=0 where idPath=%i", content.c_str(), scraper->ID().c_str(),settings.recurse,settings.parent_name,scraper->GetPathSettings().c_str(),settings.noupdate, idPath);
     }
     m_pDS->exec(strSQL);
+    // the tree has to be scanned with the new settings
+    XFILE::CChangeJournal::GetInstance().MarkChanged(filePath);
   }
   catch (...)
   {
@@ -7223,6 +7244,31 @@ bool CVideoDatabase::GetMoviesNav(const std::string& strBaseDir, CFileItemList&
   return GetMoviesByWhere(videoUrl.ToString(), filter, items, sortDescription, getDetails);
 }
 
+bool CVideoDatabase::BuildSortAndLimitSQL(const std::string &strSQL, const Filter &filter, const SortDescription &sorting, const MediaType &mediaType, std::string &strSQLExtra, int &total)
+{
+  if (!filter.limit.empty() || (sorting.limitStart <= 0 && sorting.limitEnd <= 0))
+    return false;
+
+  std::string orderBy;
+  if (sorting.sortBy != SortByNone)
+  {
+    // the order of the filter (e.g. of a smartplaylist) can't be combined with the requested one
+    if (!filter.order.empty())
+      return false;
+
+    orderBy = DatabaseUtils::BuildOrderByClause(sorting, mediaType);
+    if (orderBy.empty())
+      return false;
+  }
+
+  total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
+  if (!orderBy.empty())
+    strSQLExtra += PrepareSQL(" ORDER BY %s", orderBy.c_str());
+  strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
+
+  return true;
+}
+
 bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filter &filter, CFileItemList& items, const SortDescription &sortDescription /* = SortDescription() */, int getDetails /* = VideoDbDetailsNone */)
 {
   try
@@ -7249,14 +7295,8 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
     if (!CDatabase::BuildSQL(strSQLExtra, extFilter, strSQLExtra))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sorting.sortBy == SortByNone &&
-       (sorting.limitStart > 0 || sorting.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
-    }
+    // Let the database do the sorting and limiting if possible
+    bool sortedInSQL = BuildSortAndLimitSQL(strSQL, extFilter, sorting, MediaTypeMovie, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -7269,10 +7309,15 @@ bool CVideoDatabase::GetMoviesByWhere(const std::string& strBaseDir, const Filte
       total = iRowsFound;
     items.SetProperty("total", total);
 
+    // items sorted by the database only need to be fetched from the dataset
+    SortDescription datasetSorting = sortDescription;
+    if (sortedInSQL)
+      datasetSorting.sortBy = SortByNone;
+
     DatabaseResults results;
     results.reserve(iRowsFound);
 
-    if (!SortUtils::SortFromDataset(sortDescription, MediaTypeMovie, m_pDS, results))
+    if (!SortUtils::SortFromDataset(datasetSorting, MediaTypeMovie, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -7360,14 +7405,8 @@ bool CVideoDatabase::GetTvShowsByWhere(const std::string& strBaseDir, const Filt
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-        sorting.sortBy == SortByNone &&
-        (sorting.limitStart > 0 || sorting.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
-    }
+    // Let the database do the sorting and limiting if possible
+    bool sortedInSQL = BuildSortAndLimitSQL(strSQL, extFilter, sorting, MediaTypeTvShow, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -7380,9 +7419,14 @@ bool CVideoDatabase::GetTvShowsByWhere(const std::string& strBaseDir, const Filt
       total = iRowsFound;
     items.SetProperty("total", total);
 
+    // items sorted by the database only need to be fetched from the dataset
+    SortDescription datasetSorting = sorting;
+    if (sortedInSQL)
+      datasetSorting.sortBy = SortByNone;
+
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeTvShow, m_pDS, results))
+    if (!SortUtils::SortFromDataset(datasetSorting, MediaTypeTvShow, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -7488,14 +7532,8 @@ bool CVideoDatabase::GetEpisodesByWhere(const std::string& strBaseDir, const Fil
     if (!BuildSQL(strBaseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-      sorting.sortBy == SortByNone &&
-      (sorting.limitStart > 0 || sorting.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
-    }
+    // Let the database do the sorting and limiting if possible
+    bool sortedInSQL = BuildSortAndLimitSQL(strSQL, extFilter, sorting, MediaTypeEpisode, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -7508,9 +7546,14 @@ bool CVideoDatabase::GetEpisodesByWhere(const std::string& strBaseDir, const Fil
       total = iRowsFound;
     items.SetProperty("total", total);
 
+    // items sorted by the database only need to be fetched from the dataset
+    SortDescription datasetSorting = sorting;
+    if (sortedInSQL)
+      datasetSorting.sortBy = SortByNone;
+
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeEpisode, m_pDS, results))
+    if (!SortUtils::SortFromDataset(datasetSorting, MediaTypeEpisode, m_pDS, results))
       return false;
 
     // get data from returned rows
@@ -8357,14 +8400,8 @@ bool CVideoDatabase::GetMusicVideosByWhere(const std::string &baseDir, const Fil
     if (!BuildSQL(baseDir, strSQLExtra, extFilter, strSQLExtra, videoUrl, sorting))
       return false;
 
-    // Apply the limiting directly here if there's no special sorting but limiting
-    if (extFilter.limit.empty() &&
-      sorting.sortBy == SortByNone &&
-      (sorting.limitStart > 0 || sorting.limitEnd > 0))
-    {
-      total = (int)strtol(GetSingleValue(PrepareSQL(strSQL, "COUNT(1)") + strSQLExtra, m_pDS).c_str(), NULL, 10);
-      strSQLExtra += DatabaseUtils::BuildLimitClause(sorting.limitEnd, sorting.limitStart);
-    }
+    // Let the database do the sorting and limiting if possible
+    bool sortedInSQL = BuildSortAndLimitSQL(strSQL, extFilter, sorting, MediaTypeMusicVideo, strSQLExtra, total);
 
     strSQL = PrepareSQL(strSQL, !extFilter.fields.empty() ? extFilter.fields.c_str() : "*") + strSQLExtra;
 
@@ -8377,9 +8414,14 @@ bool CVideoDatabase::GetMusicVideosByWhere(const std::string &baseDir, const Fil
       total = iRowsFound;
     items.SetProperty("total", total);
 
+    // items sorted by the database only need to be fetched from the dataset
+    SortDescription datasetSorting = sorting;
+    if (sortedInSQL)
+      datasetSorting.sortBy = SortByNone;
+
     DatabaseResults results;
     results.reserve(iRowsFound);
-    if (!SortUtils::SortFromDataset(sorting, MediaTypeMusicVideo, m_pDS, results))
+    if (!SortUtils::SortFromDataset(datasetSorting, MediaTypeMusicVideo, m_pDS, results))
       return false;
 
     // get data from returned rows
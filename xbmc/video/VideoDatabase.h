@@ -683,6 +683,12 @@ public:
    */
   bool GetSubPaths(const std::string& basepath, std::vector< std::pair<int, std::string> >& subpaths);
 
+  /*! \brief check whether the hash of a path or one of its subpaths was invalidated.
+   \param basepath the root path to check
+   \return true if a hash below basepath was cleared (or on error), false otherwise
+   */
+  bool HasInvalidatedSubPaths(const std::string& basepath);
+
   bool GetSourcePath(const std::string &path, std::string &sourcePath);
   bool GetSourcePath(const std::string &path, std::string &sourcePath, VIDEO::SScanSettings& settings);
 
@@ -951,6 +957,17 @@ protected:
   void GetDetailsFromDB(const dbiplus::sql_record* const record, int min, int max, const SDbTableOffsets *offsets, CVideoInfoTag &details, int idxOffset = 2);
   std::string GetValueString(const CVideoInfoTag &details, int min, int max, const SDbTableOffsets *offsets) const;
 
+  /*! \brief Let the database sort and limit the items of a query if limits are requested.
+   \param strSQL the query with a placeholder for the selected fields
+   \param filter the filter the query has been built from
+   \param sorting the requested sorting and limits
+   \param mediaType the media type of the queried items
+   \param strSQLExtra the filter part of the query, the ORDER BY and LIMIT clauses are appended to it
+   \param total set to the number of items matching the filter if the query is limited
+   \return true if the query is sorted and limited by the database, false otherwise
+   */
+  bool BuildSortAndLimitSQL(const std::string &strSQL, const Filter &filter, const SortDescription &sorting, const MediaType &mediaType, std::string &strSQLExtra, int &total);
+
 private:
   void CreateTables() override;
   void CreateAnalytics() override;
@@ -21,6 +21,7 @@
 #include "dialogs/GUIDialogProgress.h"
 #include "events/EventLog.h"
 #include "events/MediaLibraryEvent.h"
+#include "filesystem/ChangeJournal.h"
 #include "filesystem/Directory.h"
 #include "filesystem/DirectoryCache.h"
 #include "filesystem/File.h"
@@ -61,6 +62,10 @@ namespace VIDEO
 {
 
   CVideoInfoScanner::CVideoInfoScanner()
+    : m_episodeRegExps(true, CRegExp::autoUtf8),
+      m_multiPartRegExp(true, CRegExp::autoUtf8),
+      m_tvshowExcludeRegExps(true, CRegExp::autoUtf8),
+      m_movieExcludeRegExps(true, CRegExp::autoUtf8)
   {
     m_bStop = false;
     m_scanAll = false;
@@ -105,6 +110,17 @@ namespace VIDEO
       m_bCanInterrupt = true;
 
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Starting scan ..");
+      CompileRegExps();
+
+      // local sources are watched before they are listed, so changes made while scanning
+      // keep them from being marked clean afterwards
+      m_useChangeJournal = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_bVideoLibraryUseChangeJournal;
+      if (m_useChangeJournal)
+      {
+        for (const auto& path : m_pathsToScan)
+          XFILE::CChangeJournal::GetInstance().Watch(path);
+        m_journalSequence = XFILE::CChangeJournal::GetInstance().GetSequence();
+      }
       CServiceBroker::GetAnnouncementManager()->Announce(ANNOUNCEMENT::VideoLibrary, "xbmc", "OnScanStarted");
 
       // Database operations should not be canceled
@@ -136,8 +152,11 @@ namespace VIDEO
           CLog::Log(LOGWARNING, "%s directory '%s' does not exist - skipping scan%s.", __FUNCTION__, CURL::GetRedacted(directory).c_str(), m_bClean ? " and clean" : "");
           m_pathsToScan.erase(m_pathsToScan.begin());
         }
-        else if (!DoScan(directory))
-          bCancelled = true;
+        else
+        {
+          if (!DoScan(directory))
+            bCancelled = true;
+        }
       }
 
       if (!bCancelled)
@@ -157,6 +176,10 @@ namespace VIDEO
 
       tick = XbmcThreads::SystemClockMillis() - tick;
       CLog::Log(LOGNOTICE, "VideoInfoScanner: Finished scan. Scanning for video info took %s", StringUtils::SecondsToTimeString(tick / 1000).c_str());
+
+      m_episodeRegExps.LogStatistics("VideoInfoScanner: tvshowmatching");
+      m_tvshowExcludeRegExps.LogStatistics("VideoInfoScanner: tvshows excludefromscan");
+      m_movieExcludeRegExps.LogStatistics("VideoInfoScanner: video excludefromscan");
     }
     catch (...)
     {
@@ -224,6 +247,21 @@ namespace VIDEO
   }
 
   bool CVideoInfoScanner::DoScan(const std::string& strDirectory)
+  {
+    // every directory whose tree ends up in sync with the library is marked clean, so later
+    // scans can skip it even if something elsewhere in the source is out of sync
+    const bool parentInSync = m_journalInSync;
+    m_journalInSync = true;
+
+    const bool ret = ScanDirectory(strDirectory);
+    if (ret && m_useChangeJournal && m_journalInSync)
+      XFILE::CChangeJournal::GetInstance().MarkClean(strDirectory, m_journalSequence);
+
+    m_journalInSync = parentInSync && m_journalInSync;
+    return ret;
+  }
+
+  bool CVideoInfoScanner::ScanDirectory(const std::string& strDirectory)
   {
     if (m_handle)
     {
@@ -252,7 +290,7 @@ namespace VIDEO
     const std::vector<std::string> &regexps = content == CONTENT_TVSHOWS ? CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowExcludeFromScanRegExps
                                                          : CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_moviesExcludeFromScanRegExps;
 
-    if (CUtil::ExcludeFileOrFolder(strDirectory, regexps))
+    if (IsExcludedFromScan(strDirectory, content == CONTENT_TVSHOWS))
       return true;
 
     if (HasNoMedia(strDirectory))
@@ -271,6 +309,16 @@ namespace VIDEO
     std::string hash, dbHash;
     if (content == CONTENT_MOVIES ||content == CONTENT_MUSICVIDEOS)
     {
+      // nothing changed in the whole tree since it was last scanned, including its subfolders,
+      // no need to list it or recurse
+      if (IsUnchangedSinceScan(strDirectory, dbHash))
+      {
+        CLog::Log(LOGDEBUG, "VideoInfoScanner: Skipping dir '%s' due to no change (change journal)", CURL::GetRedacted(strDirectory).c_str());
+        if (m_handle)
+          OnDirectoryScanned(strDirectory);
+        return true;
+      }
+
       if (m_handle)
       {
         int str = content == CONTENT_MOVIES ? 20317:20318;
@@ -360,6 +408,10 @@ namespace VIDEO
       }
       else
       {
+        // the hash isn't stored, so the directory has to be looked at again next time, unless
+        // there is nothing in it to look up, e.g. a source holding one folder per movie
+        if (std::any_of(items.begin(), items.end(), [](const CFileItemPtr& item) { return NeedsInfo(*item); }))
+          m_journalInSync = false;
         if (m_bClean)
           m_pathsToClean.insert(m_database.GetPathId(strDirectory));
         CLog::Log(LOGDEBUG, "VideoInfoScanner: No (new) information was found in dir %s", CURL::GetRedacted(strDirectory).c_str());
@@ -393,6 +445,24 @@ namespace VIDEO
     return !m_bStop;
   }
 
+  bool CVideoInfoScanner::IsUnchangedSinceScan(const std::string& path, std::string& dbHash)
+  {
+    if (!m_useChangeJournal || m_scanAll || !XFILE::CChangeJournal::GetInstance().IsUnchanged(path))
+      return false;
+
+    // directories without anything to look up have no hash. a cleared hash means the library
+    // wants the path scanned again, e.g. as an item was removed, possibly by another client
+    // of a shared database
+    m_database.GetPathHash(path, dbHash);
+    return !m_database.HasInvalidatedSubPaths(path);
+  }
+
+  bool CVideoInfoScanner::NeedsInfo(const CFileItem& item)
+  {
+    return !item.m_bIsFolder && item.IsVideo() && !item.IsNFO() &&
+           (!item.IsPlayList() || URIUtils::HasExtension(item.GetPath(), ".strm"));
+  }
+
   bool CVideoInfoScanner::RetrieveVideoInfo(CFileItemList& items, bool bDirNames, CONTENT_TYPE content, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress)
   {
     if (pDlgProgress)
@@ -426,8 +496,7 @@ namespace VIDEO
         continue;
 
       // Discard all exclude files defined by regExExclude
-      if (CUtil::ExcludeFileOrFolder(pItem->GetPath(), (content == CONTENT_TVSHOWS) ? CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowExcludeFromScanRegExps
-                                                                    : CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_moviesExcludeFromScanRegExps))
+      if (IsExcludedFromScan(pItem->GetPath(), content == CONTENT_TVSHOWS))
         continue;
 
       if (info2->Content() == CONTENT_MOVIES || info2->Content() == CONTENT_MUSICVIDEOS)
@@ -472,6 +541,10 @@ namespace VIDEO
           mediaType = MediaTypeTvShow;
         else if (info2->Content() == CONTENT_MUSICVIDEOS)
           mediaType = MediaTypeMusicVideo;
+        // shows without information are retried on the next scan
+        if (info2->Content() == CONTENT_TVSHOWS)
+          m_journalInSync = false;
+
         CServiceBroker::GetEventLog().Add(EventPtr(new CMediaLibraryEvent(
           mediaType, pItem->GetPath(), 24145,
           StringUtils::Format(g_localizeStrings.Get(24147).c_str(), mediaType.c_str(), URIUtils::GetFileName(pItem->GetPath()).c_str()),
@@ -624,8 +697,7 @@ namespace VIDEO
                                           CScraperUrl* pURL,
                                           CGUIDialogProgress* pDlgProgress)
   {
-    if (pItem->m_bIsFolder || !pItem->IsVideo() || pItem->IsNFO() ||
-       (pItem->IsPlayList() && !URIUtils::HasExtension(pItem->GetPath(), ".strm")))
+    if (!NeedsInfo(*pItem))
       return INFO_NOT_NEEDED;
 
     if (ProgressCancelled(pDlgProgress, 198, pItem->GetLabel()))
@@ -703,8 +775,7 @@ namespace VIDEO
                                                CScraperUrl* pURL,
                                                CGUIDialogProgress* pDlgProgress)
   {
-    if (pItem->m_bIsFolder || !pItem->IsVideo() || pItem->IsNFO() ||
-       (pItem->IsPlayList() && !URIUtils::HasExtension(pItem->GetPath(), ".strm")))
+    if (!NeedsInfo(*pItem))
       return INFO_NOT_NEEDED;
 
     if (ProgressCancelled(pDlgProgress, 20394, pItem->GetLabel()))
@@ -848,7 +919,12 @@ namespace VIDEO
 
       std::string hash, dbHash;
       bool allowEmptyHash = false;
-      if (item->IsPlugin())
+      if (IsUnchangedSinceScan(item->GetPath(), dbHash))
+      {
+        // nothing changed since the stored hash was computed
+        hash = dbHash;
+      }
+      else if (item->IsPlugin())
       {
         // if plugin has already calculated a hash for directory contents - use it
         // in this case we don't need to get directory listing from plugin for hash checking
@@ -976,7 +1052,7 @@ namespace VIDEO
         continue;
 
       // Discard all exclude files defined by regExExcludes
-      if (CUtil::ExcludeFileOrFolder(items[i]->GetPath(), regexps))
+      if (IsExcludedFromScan(items[i]->GetPath(), true))
         continue;
 
       /*
@@ -1089,9 +1165,49 @@ namespace VIDEO
     return false;
   }
 
+  void CVideoInfoScanner::CompileRegExps()
+  {
+    const std::shared_ptr<CAdvancedSettings> advancedSettings = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings();
+
+    std::vector<std::string> patterns;
+    m_episodeRegExpInfo.clear();
+    for (const auto& expression : advancedSettings->m_tvshowEnumRegExps)
+    {
+      patterns.push_back(expression.regexp);
+      m_episodeRegExpInfo.push_back({ expression.byDate, expression.defaultSeason });
+    }
+    m_episodeRegExps.Compile(patterns);
+
+    if (!m_multiPartRegExp.RegComp(advancedSettings->m_tvshowMultiPartEnumRegExp, CRegExp::StudyWithJitComp))
+      CLog::Log(LOGERROR, "VideoInfoScanner: Invalid multipart RegExp:'%s'", advancedSettings->m_tvshowMultiPartEnumRegExp.c_str());
+
+    m_tvshowExcludeRegExps.Compile(advancedSettings->m_tvshowExcludeFromScanRegExps);
+    m_movieExcludeRegExps.Compile(advancedSettings->m_moviesExcludeFromScanRegExps);
+
+    m_regExpsCompiled = true;
+  }
+
+  bool CVideoInfoScanner::IsExcludedFromScan(const std::string& path, bool tvshows)
+  {
+    if (path.empty())
+      return false;
+
+    if (!m_regExpsCompiled)
+      CompileRegExps();
+
+    CRegExpSet& excludes = tvshows ? m_tvshowExcludeRegExps : m_movieExcludeRegExps;
+    const int index = excludes.FindFirst(path);
+    if (index < 0)
+      return false;
+
+    CLog::LogF(LOGDEBUG, "File '{}' excluded. (Matches exclude rule RegExp: '{}')", CURL::GetRedacted(path), excludes.GetPattern(index));
+    return true;
+  }
+
   bool CVideoInfoScanner::EnumerateEpisodeItem(const CFileItem *item, EPISODELIST& episodeList)
   {
-    SETTINGS_TVSHOWLIST expression = CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowEnumRegExps;
+    if (!m_regExpsCompiled)
+      CompileRegExps();
 
     std::string strLabel;
 
@@ -1107,16 +1223,11 @@ namespace VIDEO
     // URLDecode in case an episode is on a http/https/dav/davs:// source and URL-encoded like foo%201x01%20bar.avi
     strLabel = CURL::Decode(CURL::GetRedacted(strLabel));
 
-    for (unsigned int i=0;i<expression.size();++i)
+    // patterns are tried in order, a match that can't be parsed resumes with the next pattern
+    for (int i = m_episodeRegExps.FindFirst(strLabel); i >= 0; i = m_episodeRegExps.FindFirst(strLabel, i + 1))
     {
-      CRegExp reg(true, CRegExp::autoUtf8);
-      if (!reg.RegComp(expression[i].regexp))
-        continue;
-
+      CRegExp& reg = m_episodeRegExps.GetRegExp(i);
       int regexppos, regexp2pos;
-      //CLog::Log(LOGDEBUG,"running expression %s on %s",expression[i].regexp.c_str(),strLabel.c_str());
-      if ((regexppos = reg.RegFind(strLabel.c_str())) < 0)
-        continue;
 
       EPISODE episode;
       episode.strPath = item->GetPath();
@@ -1125,8 +1236,8 @@ namespace VIDEO
       episode.cDate.SetValid(false);
       episode.isFolder = false;
 
-      bool byDate = expression[i].byDate ? true : false;
-      int defaultSeason = expression[i].defaultSeason;
+      bool byDate = m_episodeRegExpInfo[i].byDate;
+      int defaultSeason = m_episodeRegExpInfo[i].defaultSeason;
 
       if (byDate)
       {
@@ -1134,7 +1245,7 @@ namespace VIDEO
           continue;
 
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Found date based match %s (%s) [%s]", CURL::GetRedacted(episode.strPath).c_str(),
-                  episode.cDate.GetAsLocalizedDate().c_str(), expression[i].regexp.c_str());
+                  episode.cDate.GetAsLocalizedDate().c_str(), m_episodeRegExps.GetPattern(i).c_str());
       }
       else
       {
@@ -1142,7 +1253,7 @@ namespace VIDEO
           continue;
 
         CLog::Log(LOGDEBUG, "VideoInfoScanner: Found episode match %s (s%ie%i) [%s]", CURL::GetRedacted(episode.strPath).c_str(),
-                  episode.iSeason, episode.iEpisode, expression[i].regexp.c_str());
+                  episode.iSeason, episode.iEpisode, m_episodeRegExps.GetPattern(i).c_str());
       }
 
       // Grab the remainder from first regexp run
@@ -1178,9 +1289,9 @@ namespace VIDEO
       // add what we found by now
       episodeList.push_back(episode);
 
-      CRegExp reg2(true, CRegExp::autoUtf8);
+      CRegExp& reg2 = m_multiPartRegExp;
       // check the remainder of the string for any further episodes.
-      if (!byDate && reg2.RegComp(CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowMultiPartEnumRegExp))
+      if (!byDate && reg2.IsCompiled())
       {
         int offset = 0;
 
@@ -1194,7 +1305,7 @@ namespace VIDEO
 
             CLog::Log(LOGDEBUG, "VideoInfoScanner: Adding new season %u, multipart episode %u [%s]",
                       episode.iSeason, episode.iEpisode,
-                      CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowMultiPartEnumRegExp.c_str());
+                      reg2.GetPattern().c_str());
 
             episodeList.push_back(episode);
             remainder = reg.GetMatch(3);
@@ -1205,7 +1316,7 @@ namespace VIDEO
           {
             episode.iEpisode = atoi(reg2.GetMatch(1).c_str());
             CLog::Log(LOGDEBUG, "VideoInfoScanner: Adding multipart episode %u [%s]",
-                      episode.iEpisode, CServiceBroker::GetSettingsComponent()->GetAdvancedSettings()->m_tvshowMultiPartEnumRegExp.c_str());
+                      episode.iEpisode, reg2.GetPattern().c_str());
             episodeList.push_back(episode);
             offset += regexp2pos + reg2.GetFindLen();
           }
@@ -11,12 +11,13 @@
 #include "InfoScanner.h"
 #include "VideoDatabase.h"
 #include "addons/Scraper.h"
+#include "utils/RegExpSet.h"
 
 #include <set>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
-class CRegExp;
 class CFileItem;
 class CFileItemList;
 
@@ -103,9 +104,16 @@ namespace VIDEO
 
     static std::string GetMovieSetInfoFolder(const std::string& setTitle);
 
+    /*! \brief Check whether information is looked up for an item when scanning movies or music videos
+     \param item file or folder found in a scanned directory
+     \return true for video files, false for folders, NFOs and other files
+     */
+    static bool NeedsInfo(const CFileItem& item);
+
   protected:
     virtual void Process();
     bool DoScan(const std::string& strDirectory) override;
+    bool ScanDirectory(const std::string& strDirectory);
 
     INFO_RET RetrieveInfoForTvShow(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, bool fetchEpisodes, CGUIDialogProgress* pDlgProgress);
     INFO_RET RetrieveInfoForMovie(CFileItem *pItem, bool bDirNames, ADDON::ScraperPtr &scraper, bool useLocal, CScraperUrl* pURL, CGUIDialogProgress* pDlgProgress);
@@ -227,6 +235,26 @@ namespace VIDEO
     bool EnumerateSeriesFolder(CFileItem* item, EPISODELIST& episodeList);
     bool ProcessItemByVideoInfoTag(const CFileItem *item, EPISODELIST &episodeList);
 
+    /*! \brief Compile the episode, multipart and exclude expressions from advancedsettings.
+     They are compiled once per scan instead of once per file.
+     */
+    void CompileRegExps();
+
+    /*! \brief Check a path against the exclude from scan expressions
+     \param path file or folder to check
+     \param tvshows whether to use the tvshow or the movie exclude expressions
+     \return true if the path should not be scanned
+     */
+    bool IsExcludedFromScan(const std::string& path, bool tvshows);
+
+    /*! \brief Check whether a directory tree is unchanged since it was last stored, on disk
+     according to the change journal and in the library as no hash below it was cleared.
+     \param path directory to check
+     \param dbHash [out] the stored hash of the directory
+     \return true if the tree doesn't need to be looked at
+     */
+    bool IsUnchangedSinceScan(const std::string& path, std::string& dbHash);
+
     bool m_bStop;
     bool m_scanAll;
     std::string m_strStartDir;
@@ -234,6 +262,21 @@ namespace VIDEO
     std::set<std::string> m_pathsToCount;
     std::set<int> m_pathsToClean;
 
+    struct EpisodeRegExpInfo
+    {
+      bool byDate;
+      int defaultSeason;
+    };
+    bool m_useChangeJournal = false;
+    bool m_journalInSync = true; //!< the directory tree being scanned is in sync with the library
+    uint64_t m_journalSequence = 0; //!< change journal sequence from before the scan started
+    bool m_regExpsCompiled = false;
+    CRegExpSet m_episodeRegExps;
+    std::vector<EpisodeRegExpInfo> m_episodeRegExpInfo;
+    CRegExp m_multiPartRegExp;
+    CRegExpSet m_tvshowExcludeRegExps;
+    CRegExpSet m_movieExcludeRegExps;
+
   private:
     void GetLocalMovieSetArtwork(CGUIListItem::ArtMap& art,
         const std::vector<std::string>& artTypes, const std::string& setTitle);
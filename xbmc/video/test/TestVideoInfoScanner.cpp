@@ -7,6 +7,10 @@
  */
 
 #include "FileItem.h"
+#include "filesystem/ChangeJournal.h"
+#include "filesystem/Directory.h"
+#include "filesystem/SpecialProtocol.h"
+#include "utils/URIUtils.h"
 #include "video/VideoInfoScanner.h"
 
 #include <gtest/gtest.h>
@@ -62,3 +66,54 @@ TEST_P(TestVideoInfoScanner, EnumerateEpisodeItem)
 }
 
 INSTANTIATE_TEST_CASE_P(VideoInfoScanner, TestVideoInfoScanner, ValuesIn(TestData));
+
+TEST(TestVideoInfoScanner, NeedsInfo)
+{
+  EXPECT_TRUE(CVideoInfoScanner::NeedsInfo(CFileItem("/movies/Movie (2000).mkv", false)));
+  EXPECT_TRUE(CVideoInfoScanner::NeedsInfo(CFileItem("/movies/Movie (2000).strm", false)));
+  EXPECT_FALSE(CVideoInfoScanner::NeedsInfo(CFileItem("/movies/Movie (2000)/", true)));
+  EXPECT_FALSE(CVideoInfoScanner::NeedsInfo(CFileItem("/movies/Movie (2000).nfo", false)));
+  EXPECT_FALSE(CVideoInfoScanner::NeedsInfo(CFileItem("/movies/Movie (2000).jpg", false)));
+}
+
+TEST(TestVideoInfoScanner, SubfoldersOnlySource)
+{
+  // one folder per movie: the source holds no files, so there is nothing to look up in it and
+  // it is in sync as soon as its movie folders are
+  std::string source = URIUtils::AddFileToFolder(CSpecialProtocol::TranslatePath("special://temp/"),
+                                                 "TestVideoInfoScanner");
+  URIUtils::AddSlashAtEnd(source);
+  XFILE::CDirectory::RemoveRecursive(source);
+  std::string first = URIUtils::AddFileToFolder(source, "First (2000)");
+  URIUtils::AddSlashAtEnd(first);
+  std::string second = URIUtils::AddFileToFolder(source, "Second (2001)");
+  URIUtils::AddSlashAtEnd(second);
+  ASSERT_TRUE(XFILE::CDirectory::Create(first));
+  ASSERT_TRUE(XFILE::CDirectory::Create(second));
+
+  CFileItemList items;
+  ASSERT_TRUE(XFILE::CDirectory::GetDirectory(source, items, "", XFILE::DIR_FLAG_DEFAULTS));
+  EXPECT_EQ(2, items.Size());
+  for (const auto& item : items)
+    EXPECT_FALSE(CVideoInfoScanner::NeedsInfo(*item));
+
+  // the scanner marks the movie folders clean, then the source
+  XFILE::CChangeJournal& journal = XFILE::CChangeJournal::GetInstance();
+  if (journal.Watch(source))
+  {
+    const uint64_t sequence = journal.GetSequence();
+    journal.MarkClean(first, sequence);
+    journal.MarkClean(second, sequence);
+    journal.MarkClean(source, sequence);
+    EXPECT_TRUE(journal.IsUnchanged(source));
+    EXPECT_TRUE(journal.IsUnchanged(first));
+
+    // a change in one movie folder leaves the other one clean
+    ASSERT_TRUE(XFILE::CDirectory::Create(URIUtils::AddFileToFolder(first, "extras")));
+    EXPECT_FALSE(journal.IsUnchanged(first));
+    EXPECT_FALSE(journal.IsUnchanged(source));
+    EXPECT_TRUE(journal.IsUnchanged(second));
+  }
+
+  XFILE::CDirectory::RemoveRecursive(source);
+}